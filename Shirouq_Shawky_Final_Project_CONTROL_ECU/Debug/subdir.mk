@@ -6,42 +6,66 @@
 C_SRCS += \
 ../buzzer.c \
 ../control.c \
+../crc.c \
+../credentials.c \
 ../dc_motor.c \
 ../external_eeprom.c \
+../fsm.c \
 ../gpio.c \
+../power.c \
+../protocol.c \
+../scheduler.c \
+../systick.c \
 ../timer0.c \
 ../timer1.c \
 ../twi.c \
-../uart.c 
+../uart.c \
+../users.c 
 
 OBJS += \
 ./buzzer.o \
 ./control.o \
+./crc.o \
+./credentials.o \
 ./dc_motor.o \
 ./external_eeprom.o \
+./fsm.o \
 ./gpio.o \
+./power.o \
+./protocol.o \
+./scheduler.o \
+./systick.o \
 ./timer0.o \
 ./timer1.o \
 ./twi.o \
-./uart.o 
+./uart.o \
+./users.o 
 
 C_DEPS += \
 ./buzzer.d \
 ./control.d \
+./crc.d \
+./credentials.d \
 ./dc_motor.d \
 ./external_eeprom.d \
+./fsm.d \
 ./gpio.d \
+./power.d \
+./protocol.d \
+./scheduler.d \
+./systick.d \
 ./timer0.d \
 ./timer1.d \
 ./twi.d \
-./uart.d 
+./uart.d \
+./users.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
 %.o: ../%.c subdir.mk
 	@echo 'Building file: $<'
 	@echo 'Invoking: AVR Compiler'
-	avr-gcc -Wall -g2 -gstabs -O0 -fpack-struct -fshort-enums -ffunction-sections -fdata-sections -std=gnu99 -funsigned-char -funsigned-bitfields -mmcu=atmega32 -DF_CPU=8000000UL -MMD -MP -MF"$(@:%.o=%.d)" -MT"$@" -c -o "$@" "$<"
+	avr-gcc -Wall -g2 -gstabs -O0 -fpack-struct -fshort-enums -ffunction-sections -fdata-sections -fstack-usage -std=gnu99 -funsigned-char -funsigned-bitfields -mmcu=atmega32 -DF_CPU=8000000UL -MMD -MP -MF"$(@:%.o=%.d)" -MT"$@" -c -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
@@ -11,7 +11,7 @@
 
 void Buzzer_init(void)
 {
-	GPIO_setupPinDirection(BUZZER_PORT_ID,BUZZER_PIN_ID,PIN_OUTPUT);
+	GPIO_SETUP_PIN_OUTPUT(BUZZER_PORT_ID,BUZZER_PIN_ID);
 	Buzzer_off();
 
 }
@@ -20,7 +20,7 @@ void Buzzer_init(void)
  * Function to enable the Buzzer through the GPIO
  */
 void Buzzer_on(void){
-	GPIO_writePin(BUZZER_PORT_ID, BUZZER_PIN_ID, LOGIC_HIGH);
+	GPIO_WRITE_PIN(BUZZER_PORT_ID, BUZZER_PIN_ID, LOGIC_HIGH);
 
 
 }
@@ -30,6 +30,6 @@ void Buzzer_on(void){
   * Function to disable the Buzzer through the GPIO
   */
 void Buzzer_off(void){
-	GPIO_writePin(BUZZER_PORT_ID, BUZZER_PIN_ID, LOGIC_LOW);
+	GPIO_WRITE_PIN(BUZZER_PORT_ID, BUZZER_PIN_ID, LOGIC_LOW);
 
 }
@@ -8,8 +8,14 @@
 
 
 #include "external_eeprom.h"
+#include "credentials.h"
+#include "users.h"
 #include "uart.h"
-#include "timer1.h"
+#include "protocol.h"
+#include "systick.h"
+#include "scheduler.h"
+#include "power.h"
+#include "fsm.h"
 #include "timer0.h"
 #include "dc_motor.h"
 #include "twi.h"
@@ -21,42 +27,174 @@
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
-#define OPEN_TIME 15
-#define HOLDING_TIME 3
-#define CLOSE_TIME 15
-#define DANGER_TIME 60
-#define UART_DELAY 50
-#define PASS_LENGTH 5
-#define EEPROM_DELAY 10
+/* Door and alarm times in ms */
+#define OPEN_TIME 15000
+#define HOLDING_TIME 3000
+#define CLOSE_TIME 15000
+#define DANGER_TIME 60000
+#define PASS_LENGTH PROTOCOL_PASS_LENGTH
 #define MAX_ERROR_TRIALS 2
 
+/* Tasks, the ID is also the priority (0 is the highest) */
+#define TASK_ALARM   0
+#define TASK_DOOR    1
+#define TASK_LINK    2
+#define TASK_STORAGE 3
+
+/* Events of the tasks */
+#define ALARM_EVENT_START        0x01
+#define ALARM_EVENT_TIMEOUT      0x02
+#define DOOR_EVENT_OPEN          0x01
+#define DOOR_EVENT_TIMER         0x02
+#define LINK_EVENT_RX            0x01
+#define STORAGE_EVENT_SAVE_PASS  0x01
+
+/* States of the link machine */
+#define LINK_WAIT_NEW_PASS   0
+#define LINK_READY           1
+
+/* Events of the link machine, the requests use their message type */
+#define LINK_NEW_PASS        PROTOCOL_MSG_NEW_PASS
+#define LINK_OPEN_DOOR       PROTOCOL_MSG_OPEN_DOOR
+#define LINK_CHANGE_PASS     PROTOCOL_MSG_CHANGE_PASS
+#define LINK_ENROLL          PROTOCOL_MSG_ENROLL
+#define LINK_REVOKE          PROTOCOL_MSG_REVOKE
+#define LINK_PASS_DIGIT      PROTOCOL_MSG_PASS_DIGIT
+#define LINK_GET_STATE       PROTOCOL_MSG_GET_STATE
+#define LINK_PASS_SET        0x10 /* Posted when the new password is confirmed */
+#define LINK_CHANGE_ALLOWED  0x11 /* Posted when the change request has the correct password */
+
+/* States of the door machine, the events are the door task events */
+#define DOOR_CLOSED          0
+#define DOOR_OPENING         1
+#define DOOR_HOLDING         2
+#define DOOR_CLOSING         3
+
+/* States of the alarm machine, the events are the alarm task events */
+#define ALARM_OFF            0
+#define ALARM_ON             1
+
+/* Count of the streamed digits after a digit out of order, until the next first digit */
+#define STREAM_BROKEN        0xFF
+
+/* RAM available for the state machines contexts */
+#define FSM_RAM_BUDGET       96
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* RAM of the link machine, shared by all its states */
+typedef struct {
+	FSM_Machine fsm;
+	PROTOCOL_Frame frame;
+	uint8 errorTrial;
+	uint8 flag;
+} LinkContext;
+
+/* RAM of the LINK_WAIT_NEW_PASS state */
+typedef struct {
+	uint8 Password_1[PASS_LENGTH];
+	uint8 Password_2[PASS_LENGTH];
+} NewPassContext;
+
+/*
+ * RAM of the password streamed digit by digit, the master password is compared with
+ * every digit and the user codes with the last one, so the verdict is ready at Enter.
+ */
+typedef struct {
+	uint8 digits[PASS_LENGTH];
+	uint8 count;             /* Digits received in order */
+	uint8 difference;        /* ORed differences from the master password */
+	boolean user;            /* The complete code belongs to an enrolled user */
+} StreamContext;
+
+/* RAM of the door and alarm machines */
+typedef struct {
+	FSM_Machine fsm;
+	SysTick_Timer timer;
+} TimedContext;
+
 /*******************************************************************************
  *                                global variables                                  *
  *******************************************************************************/
-uint8 errorTrial = 0;
-volatile int TIMER1_g_ticks = 0;
 
-uint8 Password_1[5];
-uint8 Password_2[5];
-uint8 flag;
-uint8 OptionChoosed;
-uint16 eeprom_index;
+/*
+ * Every context is a section of its own (-fdata-sections) so its size is listed
+ * in the map file, and all of them should fit in the budget.
+ */
+LinkContext link_ctx;
+NewPassContext new_pass_ctx;
+StreamContext stream_ctx;
+TimedContext door_ctx;
+TimedContext alarm_ctx;
+
+FSM_STATIC_ASSERT(sizeof(LinkContext) + sizeof(NewPassContext) + sizeof(StreamContext) +
+		(2 * sizeof(TimedContext)) <= FSM_RAM_BUDGET, control_contexts_ram);
 
 
 /*******************************************************************************
 *                      Functions prototypes                                   *
 *******************************************************************************/
+void linkTask(uint8 events);
+boolean checkFrameLength(void);
+void doorTask(uint8 events);
+void alarmTask(uint8 events);
+void storageTask(uint8 events);
+void linkRxCallback(void);
+void doorTimerCallback(SysTick_Timer *timer);
+void alarmTimerCallback(SysTick_Timer *timer);
+void startOpening(void);
+void startHolding(void);
+void startClosing(void);
+void stopDoor(void);
+void alarmOn(void);
+void alarmOff(void);
 void createNewPass(void);
-void saveNewPassEEPROM(void);
-void TakeOptions(void) ;
+void replyLinkState(void);
+void streamDigit(void);
+void takeStreamVerdict(boolean *master, boolean *user);
 void checkPass();
+void checkDoorCode(void);
+PROTOCOL_Status updateErrorTrials(void);
 void openDoor(void) ;
-void Callback(void) ;
-void turnOnBuzzer(void);
-void turnOnMotor(void);
 void changePass();
+void enrollUser(void);
+void revokeUser(void);
 
+/*******************************************************************************
+*                      Transition Tables                                      *
+*******************************************************************************/
 
+/* Requests of the HMI, the frames not listed in the current state are ignored */
+const FSM_Transition link_table[] PROGMEM = {
+	/* state               event                 action          next */
+	{ LINK_WAIT_NEW_PASS,  LINK_NEW_PASS,        createNewPass,  FSM_SAME_STATE     },
+	{ LINK_WAIT_NEW_PASS,  LINK_PASS_SET,        NULL_PTR,       LINK_READY         },
+	{ LINK_READY,          LINK_OPEN_DOOR,       openDoor,       FSM_SAME_STATE     },
+	{ LINK_READY,          LINK_CHANGE_PASS,     changePass,     FSM_SAME_STATE     },
+	{ LINK_READY,          LINK_CHANGE_ALLOWED,  NULL_PTR,       LINK_WAIT_NEW_PASS },
+	{ LINK_READY,          LINK_ENROLL,          enrollUser,     FSM_SAME_STATE     },
+	{ LINK_READY,          LINK_REVOKE,          revokeUser,     FSM_SAME_STATE     },
+	{ LINK_READY,          LINK_PASS_DIGIT,      streamDigit,    FSM_SAME_STATE     },
+	{ FSM_ANY_STATE,       LINK_GET_STATE,       replyLinkState, FSM_SAME_STATE     },
+};
+
+/* Door sequence (OPEN - HOLD - CLOSE), an open request is ignored while the door moves */
+const FSM_Transition door_table[] PROGMEM = {
+	/* state          event              action         next */
+	{ DOOR_CLOSED,    DOOR_EVENT_OPEN,   startOpening,  DOOR_OPENING },
+	{ DOOR_OPENING,   DOOR_EVENT_TIMER,  startHolding,  DOOR_HOLDING },
+	{ DOOR_HOLDING,   DOOR_EVENT_TIMER,  startClosing,  DOOR_CLOSING },
+	{ DOOR_CLOSING,   DOOR_EVENT_TIMER,  stopDoor,      DOOR_CLOSED  },
+};
+
+/* Alarm, a new lockout while it sounds restarts its time */
+const FSM_Transition alarm_table[] PROGMEM = {
+	/* state          event                  action    next */
+	{ FSM_ANY_STATE,  ALARM_EVENT_START,     alarmOn,  ALARM_ON  },
+	{ ALARM_ON,       ALARM_EVENT_TIMEOUT,   alarmOff, ALARM_OFF },
+};
 
 /*******************************************************************************
 *                      Functions Definitions                                   *
@@ -64,9 +202,6 @@ void changePass();
 
 int main (void){
 	sei();
-	UART_ConfigType UART_configuration = {BIT_DATA_8, DISABLE_PARITY, ONE_STOP_BIT, 9600 };
-	UART_init(&UART_configuration);
-
 	TWI_BaudRate rate={TWI_F_CPU_CLOCK,2};
 	TWI_ConfigType config={1,rate};
 	TWI_init(&config);
@@ -74,232 +209,438 @@ int main (void){
 	Timer0_Config Timer0_config = { FAST_PWM_MODE,NON_INVERTING_MODE, TIMER0_F_CPU_CLOCK_8 };
 	Timer0_init(&Timer0_config);
 
-	Timer1_setCallBack(Callback);
-	Timer1_ConfigType Timer1_configuration ={ 0, 8000, F_CPU_CLOCK_1024, COMPARE_MODE };
-	Timer1_init(&Timer1_configuration);
-
+	SysTick_init();
+	POWER_init();
 
+	CREDENTIALS_init();
+	USERS_init();
 
 	DcMotor_Init();
 	Buzzer_init();
 
-	createNewPass();
-	while (1) {
-			TakeOptions();
-		}
+	// The link starts ready when a password is recovered from the EEPROM log
+	FSM_init(&link_ctx.fsm, link_table, sizeof(link_table) / sizeof(FSM_Transition),
+			CREDENTIALS_isValid() ? LINK_READY : LINK_WAIT_NEW_PASS);
+	FSM_init(&door_ctx.fsm, door_table, sizeof(door_table) / sizeof(FSM_Transition), DOOR_CLOSED);
+	FSM_init(&alarm_ctx.fsm, alarm_table, sizeof(alarm_table) / sizeof(FSM_Transition), ALARM_OFF);
+
+	Scheduler_addTask(TASK_ALARM, alarmTask);
+	Scheduler_addTask(TASK_DOOR, doorTask);
+	Scheduler_addTask(TASK_LINK, linkTask);
+	Scheduler_addTask(TASK_STORAGE, storageTask);
+
+	// The UART starts after the EEPROM scan, so the state requests of the HMI sent
+	// meanwhile are lost and repeated instead of being answered twice
+	UART_ConfigType UART_configuration = {BIT_DATA_8, DISABLE_PARITY, ONE_STOP_BIT, UART_LINK_BAUD_RATE };
+	UART_init(&UART_configuration);
+
+	// Every received byte wakes the link task, handle what arrived before
+	UART_setRxCallBack(linkRxCallback);
+	Scheduler_postEvent(TASK_LINK, LINK_EVENT_RX);
+
+	Scheduler_run();
 }
 
+/*
+ * Description :
+ * Call back of the UART receiver, it runs in the RX Complete interrupt.
+ */
+void linkRxCallback(void) {
+	Scheduler_postEvent(TASK_LINK, LINK_EVENT_RX);
+}
 
+/*
+ * Description :
+ * Task responsible for the requests of the HMI.
+ * Every complete frame is an event of the link machine:
+ * 1-a new password is required at startup and after a correct change request.
+ * 2-otherwise open the door, change the password, enroll or revoke a user.
+ * A request with a wrong payload length is refused before it reaches the machine,
+ * so the bytes left in the frame by the previous request are never used.
+ */
+void linkTask(uint8 events) {
+	while (PROTOCOL_poll(&link_ctx.frame)) {
+		if (checkFrameLength()) {
+			FSM_dispatch(&link_ctx.fsm, link_ctx.frame.type);
+		} else {
+			PROTOCOL_sendReply(PROTOCOL_STATUS_INVALID);
+		}
+	}
+}
+
+/*
+ * Description :
+ * Helper Function responsible for checking the payload length of the received request.
+ * Return TRUE if it is the length of its type, the unknown types are left to the link machine.
+ */
+boolean checkFrameLength(void) {
+	uint8 length = link_ctx.frame.length;
+
+	switch (link_ctx.frame.type) {
+	case PROTOCOL_MSG_NEW_PASS:
+		return (length == 2 * PASS_LENGTH) ? TRUE : FALSE;
+	case PROTOCOL_MSG_OPEN_DOOR:
+	case PROTOCOL_MSG_CHANGE_PASS:
+		/* Empty when the password is streamed */
+		return (length == PASS_LENGTH || length == 0) ? TRUE : FALSE;
+	case PROTOCOL_MSG_ENROLL:
+		return (length == PROTOCOL_USER_CODE_INDEX + PASS_LENGTH) ? TRUE : FALSE;
+	case PROTOCOL_MSG_REVOKE:
+		return (length == PROTOCOL_USER_ID_INDEX + 1) ? TRUE : FALSE;
+	case PROTOCOL_MSG_GET_STATE:
+		return (length == 0) ? TRUE : FALSE;
+	default:
+		return TRUE;
+	}
+}
 
 /*
  * Description :
  * Function responsible for creating new passwords
  * take 2 password from user and heck wheather they are the same or not  .
- * if the are the same, Call a function to save password in EEPROM.
+ * if the are the same, the password is used at once and the storage task saves it in EEPROM.
  */
 void createNewPass(void) {
-	// get the first password
-	for (int i = 0; i < PASS_LENGTH; i++) {
-		Password_1[i] = UART_recieveByte();
-		_delay_ms(UART_DELAY);
-	}
-	// get the second password
+	// get the password and its confirmation from the frame
 	for (int i = 0; i < PASS_LENGTH; i++) {
-		Password_2[i] = UART_recieveByte();
-		_delay_ms(UART_DELAY);
+		new_pass_ctx.Password_1[i] = link_ctx.frame.payload[i];
+		new_pass_ctx.Password_2[i] = link_ctx.frame.payload[PASS_LENGTH + i];
 	}
-	flag = 1;
+	link_ctx.flag = 1;
 // check the equality of the second and the first passwords
 	for (int i = 0; i < PASS_LENGTH; i++) {
-		if (Password_1[i] != Password_2[i]) {
-			flag = 0;
+		if (new_pass_ctx.Password_1[i] != new_pass_ctx.Password_2[i]) {
+			link_ctx.flag = 0;
 		}
 	}
-	UART_sendByte(flag);
-	if (flag == 1) {
-		saveNewPassEEPROM();
-	}
-	else {
-		createNewPass();
+	PROTOCOL_sendReply(link_ctx.flag ? PROTOCOL_STATUS_MATCH : PROTOCOL_STATUS_MISMATCH);
+	if (link_ctx.flag == 1) {
+		// The requests already received are checked with the new password,
+		// only the EEPROM write waits for the storage task
+		CREDENTIALS_set(new_pass_ctx.Password_1);
+		Scheduler_postEvent(TASK_STORAGE, STORAGE_EVENT_SAVE_PASS);
+		FSM_post(&link_ctx.fsm, LINK_PASS_SET);
 	}
 }
 
 
 /*
  * Description :
- * Function responsible for Saving the Password in the eeprom starting from location 0x0311
- * save password then increment index
- * call takeOptions function.
+ * Function responsible for telling the HMI if a password is set, at its startup.
  */
-void saveNewPassEEPROM(void) {
-	eeprom_index = 0x0311;
-	for (int i = 0; i < PASS_LENGTH; i++) {
-		uint8 key = Password_1[i];
-		EEPROM_writeByte(eeprom_index, key);
-		_delay_ms(EEPROM_DELAY);
-		eeprom_index++;
-	}
-	TakeOptions();
+void replyLinkState(void) {
+	PROTOCOL_sendReply((link_ctx.fsm.state == LINK_READY) ? PROTOCOL_STATUS_MATCH : PROTOCOL_STATUS_MISMATCH);
 }
+
 /*
  * Description :
- * Function responsible for executing the option of the user.
- * 1-open the door,call openDoor function.
- * 2-change the password, call changePass function.
+ * Task responsible for Saving the Password in the next slot of the eeprom credentials log
+ * the SRAM copy used by checkPass is already updated by createNewPass, the page write is sent in the background
  */
-void TakeOptions(void) {
-	OptionChoosed = UART_recieveByte();
-	if (OptionChoosed == '+') {
-		openDoor();
-	} else if(OptionChoosed == '-') {
-		changePass();
+void storageTask(uint8 events) {
+	if (events & STORAGE_EVENT_SAVE_PASS) {
+		CREDENTIALS_store();
 	}
 }
+
 /*
  * Description :
- * Helper Function responsible for checking the sent password to the given in the eeprom.
+ * Function responsible for a digit of the password sent while it is typed.
+ * The first digit starts a new password, a digit out of order or past the password length
+ * breaks it until the next first digit.
+ * The last digit checks the user codes, so the request sent at Enter only takes the verdict.
  */
-void checkPass() {
-    // to store the password entered by the user
-    uint8 Password[PASS_LENGTH];
+void streamDigit(void) {
+    uint8 index;
+    uint8 digit;
 
-    // Variable to store the password read from EEPROM
-    uint8 saved_password;
+    /* A malformed frame leaves the stream as it is, its payload is not used */
+    if (link_ctx.frame.length != PROTOCOL_DIGIT_LENGTH) {
+        return;
+    }
+    index = link_ctx.frame.payload[PROTOCOL_DIGIT_INDEX];
+    digit = link_ctx.frame.payload[PROTOCOL_DIGIT_VALUE];
 
-    // Initialize a flag to indicate whether the passwords match
-    flag = 1;
+    if (index == 0) {
+        stream_ctx.count = 0;
+        stream_ctx.difference = 0;
+        stream_ctx.user = FALSE;
+    }
+    if (index >= PASS_LENGTH || index != stream_ctx.count) {
+        stream_ctx.count = STREAM_BROKEN;
+        return;
+    }
 
-    // Set the EEPROM index to the starting location of the password data
-    eeprom_index = 0x0311;
+    stream_ctx.digits[index] = digit;
+    stream_ctx.difference |= CREDENTIALS_verifyDigit(index, digit);
+    stream_ctx.count++;
 
-    // Loop to receive the user's input as the entered password
-    for (int i = 0; i < PASS_LENGTH; i++) {
-        Password[i] = UART_recieveByte();
-        _delay_ms(50);
+    if (stream_ctx.count == PASS_LENGTH) {
+        stream_ctx.user = USERS_verify(stream_ctx.digits);
     }
+}
 
-    // Loop to compare the entered password with the one stored in EEPROM
-    for (int i = 0; i < PASS_LENGTH; i++) {
+/*
+ * Description :
+ * Helper Function responsible for taking the verdict of the streamed password,
+ * the same work is done whatever the digits were. The digits can be used only once.
+ */
+void takeStreamVerdict(boolean *master, boolean *user) {
+    uint8 i;
+    boolean complete = (stream_ctx.count == PASS_LENGTH) ? TRUE : FALSE;
 
-        EEPROM_readByte(eeprom_index, &saved_password);
-        _delay_ms(EEPROM_DELAY);
+    *master = (complete && stream_ctx.difference == 0) ? TRUE : FALSE;
+    *user = (complete && stream_ctx.user) ? TRUE : FALSE;
 
+    for (i = 0; i < PASS_LENGTH; i++) {
+        stream_ctx.digits[i] = 0;
+    }
+    stream_ctx.count = STREAM_BROKEN;
+    stream_ctx.user = FALSE;
+}
 
-        eeprom_index++;
+/*
+ * Description :
+ * Helper Function responsible for checking the password in the last received frame
+ * to the saved one, using its SRAM copy so no EEPROM access is needed.
+ * An empty change request uses the streamed password, the enroll and revoke requests
+ * always carry the master password.
+ */
+void checkPass() {
+    boolean master, user;
 
-        // Check if the saved_password doesn't match the corresponding character in the entered Password
-        if (saved_password != Password[i]) {
-            // If a mismatch is found, set the flag to 0 to indicate a non-matching password
-            flag = 0;
-            break;
-        }
+    // Compare the password carried by the request frame, set the flag to indicate the result
+    if (link_ctx.frame.type == PROTOCOL_MSG_CHANGE_PASS && link_ctx.frame.length == 0) {
+        takeStreamVerdict(&master, &user);
+    } else {
+        master = CREDENTIALS_verify(link_ctx.frame.payload);
     }
+    link_ctx.flag = master ? 1 : 0;
+}
 
-    // Reset the error trial counter since the password was checked successfully
-//    errorTrial = 0;
+/*
+ * Description :
+ * Helper Function responsible for checking the code in the last received frame,
+ * the door opens with the master password or the code of any enrolled user.
+ * An empty open request uses the streamed code.
+ */
+void checkDoorCode(void) {
+    boolean master, user;
+
+    // Check both so the time does not tell which one matched
+    if (link_ctx.frame.type == PROTOCOL_MSG_OPEN_DOOR && link_ctx.frame.length == 0) {
+        takeStreamVerdict(&master, &user);
+    } else {
+        master = CREDENTIALS_verify(link_ctx.frame.payload);
+        user = USERS_verify(link_ctx.frame.payload);
+    }
+    link_ctx.flag = (master || user) ? 1 : 0;
+}
+
+/*
+ * Description:
+ * Helper Function responsible for updating the error trials after checkPass
+ * and deciding the status to be sent back to the HMI.
+ * A correct password resets the trials, a wrong one is allowed MAX_ERROR_TRIALS times
+ * before the lockout.
+ */
+PROTOCOL_Status updateErrorTrials(void) {
+    if (link_ctx.flag == 1) {
+        link_ctx.errorTrial = 0;
+        return PROTOCOL_STATUS_MATCH;
+    } else if (link_ctx.errorTrial < MAX_ERROR_TRIALS) {
+        link_ctx.errorTrial++; // Increase the error trial count
+        return PROTOCOL_STATUS_MISMATCH;
+    } else {
+        link_ctx.errorTrial = 0; // Reset the error trial count
+        return PROTOCOL_STATUS_LOCKOUT;
+    }
 }
 
 /*
  * Description:
  * Function responsible for door management. It checks the entered password, controls the door, and handles errors.
+ * After a wrong password the HMI sends the next trial as a new request.
  */
 void openDoor(void) {
-    // Check the entered password and set the 'flag' variable to indicate the result
-    checkPass();
+    PROTOCOL_Status status;
 
-    // Send the 'flag' value back via UART
-    UART_sendByte(flag);
+    // Check the entered code and set the 'flag' variable to indicate the result
+    checkDoorCode();
+    status = updateErrorTrials();
 
-    // If the password matches and no previous errors, proceed to open the door
-    if (flag == 1 && errorTrial == 0) {
-        turnOnMotor(); // Open the door
-    }
-    // If the password does not match and the error trial count is less than the maximum allowed, retry
-    else if (flag == 0 && errorTrial < MAX_ERROR_TRIALS) {
-        errorTrial++; // Increase the error trial count
-        openDoor(); // Recursive call to retry the operation
+    // Send the result back to the HMI
+    PROTOCOL_sendReply(status);
+
+    // If the password matches, proceed to open the door
+    if (status == PROTOCOL_STATUS_MATCH) {
+        Scheduler_postEvent(TASK_DOOR, DOOR_EVENT_OPEN); // Open the door
     }
-    // If the error trial count exceeds the maximum allowed, sound the buzzer and reset the count
-    else if ((errorTrial >= MAX_ERROR_TRIALS)&&(flag==0)) {
-    	turnOnBuzzer(); // Sound the buzzer to indicate multiple errors
-        errorTrial = 0; // Reset the error trial count
+    // If the error trial count exceeds the maximum allowed, sound the buzzer
+    else if (status == PROTOCOL_STATUS_LOCKOUT) {
+        Scheduler_postEvent(TASK_ALARM, ALARM_EVENT_START); // Sound the buzzer to indicate multiple errors
     }
 }
 
-
 /*
- * Description :
- * Function responsible for call back for timer 1 .
+ * Description:
+ * Task responsible for the alarm, every event is dispatched to the alarm machine.
  */
-void Callback(void) {
-	TIMER1_g_ticks++;
+void alarmTask(uint8 events) {
+    if (events & ALARM_EVENT_START) {
+        FSM_dispatch(&alarm_ctx.fsm, ALARM_EVENT_START);
+    }
+    if (events & ALARM_EVENT_TIMEOUT) {
+        FSM_dispatch(&alarm_ctx.fsm, ALARM_EVENT_TIMEOUT);
+    }
 }
+
 /*
  * Description:
  * Function responsible for turning on the buzzer to indicate errors.
+ * The alarm timer turns it off after DANGER_TIME, the requests are served meanwhile.
  */
-void turnOnBuzzer(void) {
-    TIMER1_g_ticks = 0; // Reset the timer ticks to 0
-
+void alarmOn(void) {
     Buzzer_on(); // Turn on the buzzer to produce sound
 
-    // Wait for a specified duration (DANGER_TIME) while the buzzer is on
-    while (TIMER1_g_ticks < DANGER_TIME); // Wait until the timer reaches the specified danger time
+    // Schedule the end of the alarm
+    SysTick_startTimer(&alarm_ctx.timer, DANGER_TIME, 0, alarmTimerCallback);
+}
 
-    Buzzer_off(); // Turn off the buzzer after the specified duration
+/*
+ * Description:
+ * Function responsible for turning off the buzzer after the specified duration.
+ */
+void alarmOff(void) {
+    Buzzer_off();
 }
 
 /*
  * Description:
- * Function responsible for controlling the motor to perform door operations (OPEN - HOLD - CLOSE).
+ * Call back of the alarm timer, it runs in the Timer1 interrupt.
  */
-void turnOnMotor(void) {
-    TIMER1_g_ticks = 0; // Reset the timer ticks to 0
+void alarmTimerCallback(SysTick_Timer *timer) {
+    Scheduler_postEvent(TASK_ALARM, ALARM_EVENT_TIMEOUT);
+}
 
-    DcMotor_Rotate(CW); // Rotate the motor in the clockwise direction (OPEN)
+/*
+ * Description:
+ * Task responsible for controlling the motor to perform door operations (OPEN - HOLD - CLOSE).
+ * Every event is dispatched to the door machine.
+ */
+void doorTask(uint8 events) {
+    if (events & DOOR_EVENT_OPEN) {
+        FSM_dispatch(&door_ctx.fsm, DOOR_EVENT_OPEN);
+    }
+    if (events & DOOR_EVENT_TIMER) {
+        FSM_dispatch(&door_ctx.fsm, DOOR_EVENT_TIMER);
+    }
+}
 
-    // Wait for the specified duration (OPEN_TIME) while the motor is rotating in the OPEN direction
-    while (TIMER1_g_ticks < OPEN_TIME);
+/*
+ * Description:
+ * Door actions, every phase moves the motor and schedules the end of the phase.
+ */
+void startOpening(void) {
+    DcMotor_Rotate(CW); // Rotate the motor in the clockwise direction (OPEN)
+    SysTick_startTimer(&door_ctx.timer, OPEN_TIME, 0, doorTimerCallback);
+}
 
+void startHolding(void) {
     DcMotor_Rotate(STOP); // Stop the motor (HOLD)
+    SysTick_startTimer(&door_ctx.timer, HOLDING_TIME, 0, doorTimerCallback);
+}
 
-    // Wait for the specified duration (HOLDING_TIME) while the door is held in place
-    while (TIMER1_g_ticks < OPEN_TIME + HOLDING_TIME);
-
+void startClosing(void) {
     DcMotor_Rotate(A_CW); // Rotate the motor in the anti-clockwise direction (CLOSE)
+    SysTick_startTimer(&door_ctx.timer, CLOSE_TIME, 0, doorTimerCallback);
+}
 
-    // Wait for the specified duration (CLOSE_TIME) while the motor is rotating in the CLOSE direction
-    while (TIMER1_g_ticks < OPEN_TIME + HOLDING_TIME + CLOSE_TIME);
-
+void stopDoor(void) {
     DcMotor_Rotate(STOP); // Stop the motor (Door is now closed)
 }
 
+/*
+ * Description:
+ * Call back of the door timer, it runs in the Timer1 interrupt.
+ */
+void doorTimerCallback(SysTick_Timer *timer) {
+    Scheduler_postEvent(TASK_DOOR, DOOR_EVENT_TIMER);
+}
+
 /*
  * Description:
  * Function responsible for changing the password based on user input and handling error conditions.
+ * After a correct password the link machine waits for the new password.
  */
 void changePass(void) {
+    PROTOCOL_Status status;
+
     // Check the entered password and set the 'flag' variable to indicate the result
     checkPass();
+    status = updateErrorTrials();
 
-    // Send the 'flag' value back via UART
-    UART_sendByte(flag);
+    // Send the result back to the HMI
+    PROTOCOL_sendReply(status);
 
-    // If the error trial count has reached the maximum allowed, sound the buzzer and reset the count
-    if (errorTrial >= MAX_ERROR_TRIALS) {
-        turnOnBuzzer(); // Sound the buzzer to indicate multiple errors
-        errorTrial = 0; // Reset the error trial count
+    // If the error trial count has reached the maximum allowed, sound the buzzer
+    if (status == PROTOCOL_STATUS_LOCKOUT) {
+        Scheduler_postEvent(TASK_ALARM, ALARM_EVENT_START); // Sound the buzzer to indicate multiple errors
     }
-    // If the error trial count is within the limit and the entered password is correct, allow password change
-    else if (errorTrial ==0 && flag == 1) {
-        createNewPass(); // Initiate the process to create a new password
+    // If the entered password is correct, allow password change
+    else if (status == PROTOCOL_STATUS_MATCH) {
+        FSM_post(&link_ctx.fsm, LINK_CHANGE_ALLOWED); // Wait for the new password
+    }
+}
+
+/*
+ * Description:
+ * Function responsible for adding a user after checking the master password.
+ * The payload holds the master password, the user ID and the user code.
+ */
+void enrollUser(void) {
+    PROTOCOL_Status status;
+
+    // Check the master password and set the 'flag' variable to indicate the result
+    checkPass();
+    status = updateErrorTrials();
+
+    // Add the user, refuse if the table is full or the code is used by another user
+    if (status == PROTOCOL_STATUS_MATCH &&
+            USERS_enroll(link_ctx.frame.payload[PROTOCOL_USER_ID_INDEX],
+                    &link_ctx.frame.payload[PROTOCOL_USER_CODE_INDEX]) != SUCCESS) {
+        status = PROTOCOL_STATUS_REFUSED;
     }
-    // If the error trial count is within the limit, the entered password is incorrect, and not exceeding the limit, retry
-    else if (flag == 0 && errorTrial < MAX_ERROR_TRIALS) {
-        errorTrial++; // Increase the error trial count
-        changePass(); // Recursive call to retry the password change
+
+    // Send the result back to the HMI
+    PROTOCOL_sendReply(status);
+
+    if (status == PROTOCOL_STATUS_LOCKOUT) {
+        Scheduler_postEvent(TASK_ALARM, ALARM_EVENT_START); // Sound the buzzer to indicate multiple errors
     }
 }
 
+/*
+ * Description:
+ * Function responsible for removing a user after checking the master password.
+ * The payload holds the master password and the user ID.
+ */
+void revokeUser(void) {
+    PROTOCOL_Status status;
+
+    // Check the master password and set the 'flag' variable to indicate the result
+    checkPass();
+    status = updateErrorTrials();
+
+    // Remove the user, refuse if the ID is not enrolled
+    if (status == PROTOCOL_STATUS_MATCH && USERS_revoke(link_ctx.frame.payload[PROTOCOL_USER_ID_INDEX]) != SUCCESS) {
+        status = PROTOCOL_STATUS_REFUSED;
+    }
 
+    // Send the result back to the HMI
+    PROTOCOL_sendReply(status);
 
+    if (status == PROTOCOL_STATUS_LOCKOUT) {
+        Scheduler_postEvent(TASK_ALARM, ALARM_EVENT_START); // Sound the buzzer to indicate multiple errors
+    }
+}
@@ -0,0 +1,57 @@
+ /******************************************************************************
+ *
+ * Module: CRC
+ *
+ * File Name: crc.c
+ *
+ * Description: Source file for the CRC-8 checksum helpers
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#include "crc.h"
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Add one byte to a running CRC-8 value and return the new value.
+ * Bitwise implementation, no lookup table to keep the flash usage small.
+ */
+uint8 CRC8_update(uint8 crc, uint8 data)
+{
+	uint8 bit;
+
+	crc ^= data;
+	for(bit = 0; bit < 8; bit++)
+	{
+		if(crc & 0x80)
+		{
+			crc = (uint8)((crc << 1) ^ CRC8_POLYNOMIAL);
+		}
+		else
+		{
+			crc = (uint8)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+/*
+ * Description :
+ * Calculate the CRC-8 of a whole buffer starting from CRC8_INITIAL_VALUE.
+ */
+uint8 CRC8_compute(const uint8 *data, uint8 length)
+{
+	uint8 i;
+	uint8 crc = CRC8_INITIAL_VALUE;
+
+	for(i = 0; i < length; i++)
+	{
+		crc = CRC8_update(crc, data[i]);
+	}
+	return crc;
+}
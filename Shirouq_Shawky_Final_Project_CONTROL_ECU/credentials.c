@@ -0,0 +1,211 @@
+ /******************************************************************************
+ *
+ * Module: CREDENTIALS
+ *
+ * File Name: credentials.c
+ *
+ * Description: Source file for the password store with its SRAM mirror
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#include "credentials.h"
+#include "twi.h"
+#include "crc.h"
+#include "power.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Offsets inside a record */
+#define RECORD_MARKER_INDEX      0
+#define RECORD_SEQUENCE_INDEX    1
+#define RECORD_PASS_INDEX        3
+#define RECORD_CRC_INDEX         (CREDENTIALS_RECORD_SIZE - 1)
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* SRAM mirror of the password, the last byte is its CRC-8 */
+static uint8 g_mirror[CREDENTIALS_PASS_LENGTH + 1];
+static boolean g_mirrorValid = FALSE;
+
+/* Position of the newest record in the log */
+static uint8 g_newestSlot;
+static uint16 g_newestSequence;
+
+/* Record being written, so the mirror can change while the write is on the bus */
+static uint8 g_writeRecord[CREDENTIALS_RECORD_SIZE];
+static TWI_Transaction g_writeTransaction;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* Scan the log and load the newest valid record into the mirror */
+static void CREDENTIALS_load(void);
+
+/* Check the mirror against its CRC */
+static boolean CREDENTIALS_mirrorIntact(void);
+
+/* Return TRUE if sequence a comes after sequence b, valid across the 16-bit wrap */
+static boolean CREDENTIALS_isNewer(uint16 a, uint16 b);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+static boolean CREDENTIALS_mirrorIntact(void)
+{
+	return (CRC8_compute(g_mirror, CREDENTIALS_PASS_LENGTH) == g_mirror[CREDENTIALS_PASS_LENGTH]) ? TRUE : FALSE;
+}
+
+static boolean CREDENTIALS_isNewer(uint16 a, uint16 b)
+{
+	return ((a != b) && ((uint16)(a - b) < 0x8000)) ? TRUE : FALSE;
+}
+
+static void CREDENTIALS_load(void)
+{
+	uint8 record[CREDENTIALS_RECORD_SIZE];
+	uint8 slot;
+	uint8 i;
+	uint16 sequence;
+
+	g_mirrorValid = FALSE;
+
+	for(slot = 0; slot < CREDENTIALS_SLOT_COUNT; slot++)
+	{
+		if(EEPROM_readBlock(CREDENTIALS_LOG_START + ((uint16)slot * CREDENTIALS_SLOT_SIZE),
+				record, CREDENTIALS_RECORD_SIZE) != SUCCESS)
+		{
+			continue;
+		}
+
+		/* Erased or torn slots are skipped */
+		if((record[RECORD_MARKER_INDEX] != CREDENTIALS_RECORD_MARKER) ||
+				(CRC8_compute(record, RECORD_CRC_INDEX) != record[RECORD_CRC_INDEX]))
+		{
+			continue;
+		}
+
+		sequence = record[RECORD_SEQUENCE_INDEX] | ((uint16)record[RECORD_SEQUENCE_INDEX + 1] << 8);
+
+		if((g_mirrorValid == FALSE) || (CREDENTIALS_isNewer(sequence, g_newestSequence) == TRUE))
+		{
+			g_newestSlot = slot;
+			g_newestSequence = sequence;
+			for(i = 0; i < CREDENTIALS_PASS_LENGTH; i++)
+			{
+				g_mirror[i] = record[RECORD_PASS_INDEX + i];
+			}
+			g_mirror[CREDENTIALS_PASS_LENGTH] = CRC8_compute(g_mirror, CREDENTIALS_PASS_LENGTH);
+			g_mirrorValid = TRUE;
+		}
+	}
+
+	if(g_mirrorValid == FALSE)
+	{
+		/* Empty log, the first record goes to slot 0 */
+		g_newestSlot = CREDENTIALS_SLOT_COUNT - 1;
+		g_newestSequence = 0xFFFF;
+	}
+}
+
+void CREDENTIALS_init(void)
+{
+	CREDENTIALS_load();
+}
+
+boolean CREDENTIALS_isValid(void)
+{
+	return g_mirrorValid;
+}
+
+boolean CREDENTIALS_verify(const uint8 *password)
+{
+	uint8 i;
+	uint8 difference = 0;
+
+	if((g_mirrorValid == TRUE) && (CREDENTIALS_mirrorIntact() == FALSE))
+	{
+		/* The SRAM copy got corrupted, get it again from the EEPROM */
+		CREDENTIALS_load();
+	}
+
+	if(g_mirrorValid == FALSE)
+	{
+		return FALSE;
+	}
+
+	/* Check all the digits even after a mismatch */
+	for(i = 0; i < CREDENTIALS_PASS_LENGTH; i++)
+	{
+		difference |= (uint8)(g_mirror[i] ^ password[i]);
+	}
+
+	return (difference == 0) ? TRUE : FALSE;
+}
+
+uint8 CREDENTIALS_verifyDigit(uint8 index, uint8 digit)
+{
+	if((g_mirrorValid == TRUE) && (CREDENTIALS_mirrorIntact() == FALSE))
+	{
+		/* The SRAM copy got corrupted, get it again from the EEPROM */
+		CREDENTIALS_load();
+	}
+
+	if((g_mirrorValid == FALSE) || (index >= CREDENTIALS_PASS_LENGTH))
+	{
+		return 0xFF;
+	}
+
+	return (uint8)(g_mirror[index] ^ digit);
+}
+
+void CREDENTIALS_set(const uint8 *password)
+{
+	uint8 i;
+
+	for(i = 0; i < CREDENTIALS_PASS_LENGTH; i++)
+	{
+		g_mirror[i] = password[i];
+	}
+	g_mirror[CREDENTIALS_PASS_LENGTH] = CRC8_compute(g_mirror, CREDENTIALS_PASS_LENGTH);
+	g_mirrorValid = TRUE;
+}
+
+uint8 CREDENTIALS_store(void)
+{
+	uint8 i;
+
+	/* A corrupted mirror is never written over the good records */
+	if((g_mirrorValid == FALSE) || (CREDENTIALS_mirrorIntact() == FALSE))
+	{
+		return ERROR;
+	}
+
+	/* The previous record should be on the EEPROM before its buffer is reused */
+	POWER_WAIT_WHILE((g_writeTransaction.status == TWI_TRANSACTION_QUEUED) ||
+			(g_writeTransaction.status == TWI_TRANSACTION_BUSY));
+
+	/* Append after the newest record, the old one stays valid until this write completes */
+	g_newestSlot = (g_newestSlot + 1) % CREDENTIALS_SLOT_COUNT;
+	g_newestSequence++;
+
+	g_writeRecord[RECORD_MARKER_INDEX] = CREDENTIALS_RECORD_MARKER;
+	g_writeRecord[RECORD_SEQUENCE_INDEX] = (uint8)g_newestSequence;
+	g_writeRecord[RECORD_SEQUENCE_INDEX + 1] = (uint8)(g_newestSequence >> 8);
+	for(i = 0; i < CREDENTIALS_PASS_LENGTH; i++)
+	{
+		g_writeRecord[RECORD_PASS_INDEX + i] = g_mirror[i];
+	}
+	g_writeRecord[RECORD_CRC_INDEX] = CRC8_compute(g_writeRecord, RECORD_CRC_INDEX);
+
+	return EEPROM_writePageAsync(&g_writeTransaction,
+			CREDENTIALS_LOG_START + ((uint16)g_newestSlot * CREDENTIALS_SLOT_SIZE),
+			g_writeRecord, CREDENTIALS_RECORD_SIZE, NULL_PTR);
+}
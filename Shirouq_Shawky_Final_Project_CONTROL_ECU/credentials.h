@@ -0,0 +1,93 @@
+ /******************************************************************************
+ *
+ * Module: CREDENTIALS
+ *
+ * File Name: credentials.h
+ *
+ * Description: Header file for the password store with its SRAM mirror
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#ifndef CREDENTIALS_H_
+#define CREDENTIALS_H_
+
+#include "std_types.h"
+#include "external_eeprom.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define CREDENTIALS_PASS_LENGTH        5
+
+/*
+ * The records are appended to a log of slots in the upper half of the EEPROM, one page
+ * each, so every password change is a single page write on the next slot and the wear
+ * is spread over all of them. The newest valid record is found at startup by its sequence.
+ */
+#define CREDENTIALS_LOG_START          0x0400
+#define CREDENTIALS_SLOT_SIZE          EEPROM_PAGE_SIZE
+#define CREDENTIALS_SLOT_COUNT         64
+
+/* Record: marker, sequence (low byte first), password, CRC-8 of all the previous bytes */
+#define CREDENTIALS_RECORD_MARKER      0xA5
+#define CREDENTIALS_RECORD_SIZE        (CREDENTIALS_PASS_LENGTH + 4)
+
+#if ((CREDENTIALS_LOG_START + (CREDENTIALS_SLOT_COUNT * CREDENTIALS_SLOT_SIZE)) > EEPROM_SIZE)
+#error "The credentials log does not fit in the EEPROM"
+#endif
+
+#if (CREDENTIALS_RECORD_SIZE > CREDENTIALS_SLOT_SIZE)
+#error "The credentials record does not fit in one slot"
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Scan the log for the newest valid record and load it into the SRAM mirror.
+ * Should be called once at startup after the TWI initialization.
+ */
+void CREDENTIALS_init(void);
+
+/*
+ * Description :
+ * Return TRUE if a valid password is held in the SRAM mirror.
+ */
+boolean CREDENTIALS_isValid(void);
+
+/*
+ * Description :
+ * Compare the entered password with the SRAM mirror, no EEPROM access unless the
+ * mirror fails its integrity check. The comparison time does not depend on the digits.
+ * Return TRUE if they match.
+ */
+boolean CREDENTIALS_verify(const uint8 *password);
+
+/*
+ * Description :
+ * Compare one digit of the entered password with the digit at the same index of the
+ * SRAM mirror, so a password can be checked while it is typed. The time does not
+ * depend on the digits.
+ * Return zero if they match, the results of all the digits should be ORed together.
+ */
+uint8 CREDENTIALS_verifyDigit(uint8 index, uint8 digit);
+
+/*
+ * Description :
+ * Update the SRAM mirror, the new password is used at once by CREDENTIALS_verify.
+ * CREDENTIALS_store should be called later to keep it in the EEPROM.
+ */
+void CREDENTIALS_set(const uint8 *password);
+
+/*
+ * Description :
+ * Append the password of the SRAM mirror to the next slot of the log in the background.
+ * Return SUCCESS if the EEPROM write is queued.
+ */
+uint8 CREDENTIALS_store(void);
+
+#endif /* CREDENTIALS_H_ */
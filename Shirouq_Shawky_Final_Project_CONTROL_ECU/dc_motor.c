@@ -16,8 +16,8 @@
  * Stop at the DC-Motor at the beginning through the GPIO driver.
  */
 void DcMotor_Init(void){
-	GPIO_setupPinDirection(DC_MOTOR_PIN1_PORT_ID,DC_MOTOR_PIN1_ID,PIN_OUTPUT);
-	GPIO_setupPinDirection(DC_MOTOR_PIN2_PORT_ID,DC_MOTOR_PIN2_ID,PIN_OUTPUT);
+	GPIO_SETUP_PIN_OUTPUT(DC_MOTOR_PIN1_PORT_ID,DC_MOTOR_PIN1_ID);
+	GPIO_SETUP_PIN_OUTPUT(DC_MOTOR_PIN2_PORT_ID,DC_MOTOR_PIN2_ID);
 	DcMotor_Rotate(STOP);
 }
 
@@ -29,18 +29,16 @@ void DcMotor_Init(void){
  */
 void DcMotor_Rotate(DcMotor_State state) {
 
+	/* Both pins change in one write so the H-bridge never sees a mixed state */
 	switch (state) {
 	case STOP:
-		GPIO_writePin(DC_MOTOR_PIN1_PORT_ID, DC_MOTOR_PIN1_ID, LOGIC_LOW);
-		GPIO_writePin(DC_MOTOR_PIN2_PORT_ID, DC_MOTOR_PIN2_ID, LOGIC_LOW);
+		GPIO_WRITE_MASKED(DC_MOTOR_PIN1_PORT_ID, DC_MOTOR_PINS_MASK, 0);
 		break;
 	case CW:
-		GPIO_writePin(DC_MOTOR_PIN1_PORT_ID, DC_MOTOR_PIN1_ID, LOGIC_LOW);
-		GPIO_writePin(DC_MOTOR_PIN2_PORT_ID, DC_MOTOR_PIN2_ID, LOGIC_HIGH);
+		GPIO_WRITE_MASKED(DC_MOTOR_PIN1_PORT_ID, DC_MOTOR_PINS_MASK, (1 << DC_MOTOR_PIN2_ID));
 		break;
 	case A_CW:
-		GPIO_writePin(DC_MOTOR_PIN1_PORT_ID, DC_MOTOR_PIN1_ID, LOGIC_HIGH);
-		GPIO_writePin(DC_MOTOR_PIN2_PORT_ID, DC_MOTOR_PIN2_ID, LOGIC_LOW);
+		GPIO_WRITE_MASKED(DC_MOTOR_PIN1_PORT_ID, DC_MOTOR_PINS_MASK, (1 << DC_MOTOR_PIN1_ID));
 		break;
 	}
 	Timer0_PWM_Start(100);
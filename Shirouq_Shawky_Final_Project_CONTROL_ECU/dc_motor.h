@@ -17,6 +17,13 @@
 #define DC_MOTOR_PIN2_PORT_ID       PORTB_ID
 #define DC_MOTOR_PIN2_ID            PIN1_ID
 
+/* The two pins should be in the same port so they change together */
+#if (DC_MOTOR_PIN1_PORT_ID != DC_MOTOR_PIN2_PORT_ID)
+#error "The DC Motor pins should be in the same port"
+#endif
+
+#define DC_MOTOR_PINS_MASK          ((1 << DC_MOTOR_PIN1_ID) | (1 << DC_MOTOR_PIN2_ID))
+
 /*Types Declaration*/
 typedef enum {
 	STOP, CW, A_CW
@@ -12,19 +12,91 @@
 #include "external_eeprom.h"
 #include "twi.h"
 
-uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data)
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Set after every write STOP, the device is busy until it acknowledges its address again */
+static boolean g_writeCyclePending = FALSE;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/*
+ * Send the Start Bit and the device address with R/W=0 (write) for u16addr.
+ * If a write cycle is pending, keep polling the address until it is acknowledged.
+ */
+static uint8 EEPROM_startWrite(uint16 u16addr);
+
+/*
+ * Fill the common part of an asynchronous transaction for u16addr.
+ */
+static void EEPROM_setupTransaction(TWI_Transaction *transaction,uint16 u16addr,
+		void (*callback)(TWI_Transaction *transaction));
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+static uint8 EEPROM_startWrite(uint16 u16addr)
 {
-	/* Send the Start Bit */
+    uint16 tries = EEPROM_ACK_POLL_MAX_TRIES;
+    uint8 status;
+
+    /* Send the Start Bit */
     TWI_start();
-    if (TWI_getStatus() != TWI_START)
+    status = TWI_getStatus();
+
+    while(1)
+    {
+        if ((status != TWI_START) && (status != TWI_REP_START))
+            return ERROR;
+
+        /* Send the device address, we need to get A8 A9 A10 address bits from the
+         * memory location address and R/W=0 (write) */
+        TWI_writeByte((uint8)(0xA0 | ((u16addr & 0x0700)>>7)));
+        status = TWI_getStatus();
+
+        if (status == TWI_MT_SLA_W_ACK)
+        {
+            /* Device is ready, continue in the same transaction */
+            g_writeCyclePending = FALSE;
+            return SUCCESS;
+        }
+
+        /* A NACK is only expected while the write cycle is in progress */
+        if ((status != TWI_MT_SLA_W_NACK) || (g_writeCyclePending == FALSE) || (--tries == 0))
+        {
+            TWI_stop();
+            return ERROR;
+        }
+
+        /* Poll again with a Repeated Start */
+        TWI_start();
+        status = TWI_getStatus();
+    }
+}
+
+uint8 EEPROM_waitWriteComplete(void)
+{
+    if (g_writeCyclePending == FALSE)
+        return SUCCESS;
+
+    /* Poll the device, then release the bus */
+    if (EEPROM_startWrite(0) != SUCCESS)
         return ERROR;
-		
-    /* Send the device address, we need to get A8 A9 A10 address bits from the
-     * memory location address and R/W=0 (write) */
-    TWI_writeByte((uint8)(0xA0 | ((u16addr & 0x0700)>>7)));
-    if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
-        return ERROR; 
-		 
+
+    TWI_stop();
+    return SUCCESS;
+}
+
+uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data)
+{
+    /* Send the Start Bit and the device address, waiting for the last write cycle */
+    if (EEPROM_startWrite(u16addr) != SUCCESS)
+        return ERROR;
+
     /* Send the required memory location address */
     TWI_writeByte((uint8)(u16addr));
     if (TWI_getStatus() != TWI_MT_DATA_ACK)
@@ -35,43 +107,100 @@ uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data)
     if (TWI_getStatus() != TWI_MT_DATA_ACK)
         return ERROR;
 
-    /* Send the Stop Bit */
+    /* Send the Stop Bit, the write cycle starts now */
     TWI_stop();
+    g_writeCyclePending = TRUE;
 	
     return SUCCESS;
 }
 
 uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data)
 {
-	/* Send the Start Bit */
-    TWI_start();
-    if (TWI_getStatus() != TWI_START)
-        return ERROR;
-		
-    /* Send the device address, we need to get A8 A9 A10 address bits from the
-     * memory location address and R/W=0 (write) */
-    TWI_writeByte((uint8)((0xA0) | ((u16addr & 0x0700)>>7)));
-    if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
+    return EEPROM_readBlock(u16addr, u8data, 1);
+}
+
+uint8 EEPROM_writeBlock(uint16 u16addr, const uint8 *data, uint16 length)
+{
+    uint16 page_length;
+
+    while(length > 0)
+    {
+        /* Number of bytes left in the current page, the device address counter
+         * rolls over inside the page so a write should not cross it */
+        page_length = EEPROM_PAGE_SIZE - (u16addr % EEPROM_PAGE_SIZE);
+        if(page_length > length)
+        {
+            page_length = length;
+        }
+
+        /* Send the Start Bit and the device address, waiting for the previous page write cycle */
+        if (EEPROM_startWrite(u16addr) != SUCCESS)
+            return ERROR;
+
+        /* Send the required memory location address */
+        TWI_writeByte((uint8)(u16addr));
+        if (TWI_getStatus() != TWI_MT_DATA_ACK)
+            return ERROR;
+
+        /* write the page bytes to eeprom */
+        length -= page_length;
+        u16addr += page_length;
+        while(page_length > 0)
+        {
+            TWI_writeByte(*data);
+            if (TWI_getStatus() != TWI_MT_DATA_ACK)
+                return ERROR;
+            data++;
+            page_length--;
+        }
+
+        /* Send the Stop Bit, the page is programmed after it */
+        TWI_stop();
+        g_writeCyclePending = TRUE;
+    }
+
+    return SUCCESS;
+}
+
+uint8 EEPROM_readBlock(uint16 u16addr, uint8 *data, uint16 length)
+{
+    if(length == 0)
+        return SUCCESS;
+
+    /* Send the Start Bit and the device address with R/W=0 (write) to set the address,
+     * only waits if a write cycle is still in progress */
+    if (EEPROM_startWrite(u16addr) != SUCCESS)
         return ERROR;
-		
+
     /* Send the required memory location address */
     TWI_writeByte((uint8)(u16addr));
     if (TWI_getStatus() != TWI_MT_DATA_ACK)
         return ERROR;
-		
+
     /* Send the Repeated Start Bit */
     TWI_start();
     if (TWI_getStatus() != TWI_REP_START)
         return ERROR;
-		
+
     /* Send the device address, we need to get A8 A9 A10 address bits from the
      * memory location address and R/W=1 (Read) */
     TWI_writeByte((uint8)((0xA0) | ((u16addr & 0x0700)>>7) | 1));
     if (TWI_getStatus() != TWI_MT_SLA_R_ACK)
         return ERROR;
 
-    /* Read Byte from Memory without send ACK */
-    *u8data = TWI_readByteWithNACK();
+    /* Sequential read: ACK every byte to get the next one from the device
+     * address counter, except the last one */
+    while(length > 1)
+    {
+        *data = TWI_readByteWithACK();
+        if (TWI_getStatus() != TWI_MR_DATA_ACK)
+            return ERROR;
+        data++;
+        length--;
+    }
+
+    /* Read the last byte without send ACK to end the transfer */
+    *data = TWI_readByteWithNACK();
     if (TWI_getStatus() != TWI_MR_DATA_NACK)
         return ERROR;
 
@@ -80,3 +209,55 @@ uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data)
 
     return SUCCESS;
 }
+
+static void EEPROM_setupTransaction(TWI_Transaction *transaction, uint16 u16addr,
+		void (*callback)(TWI_Transaction *transaction))
+{
+    /* 7-bit device address 1010 with A8 A9 A10 address bits from the memory location address */
+    transaction->address = (uint8)(0x50 | ((u16addr & 0x0700)>>8));
+    transaction->sub_address[0] = (uint8)(u16addr);
+    transaction->sub_address_length = 1;
+    transaction->write_buffer = NULL_PTR;
+    transaction->write_length = 0;
+    transaction->read_buffer = NULL_PTR;
+    transaction->read_length = 0;
+    /* The TWI ISR does the acknowledge polling if a write cycle is in progress */
+    transaction->address_retries = EEPROM_ACK_POLL_MAX_TRIES;
+    transaction->callback = callback;
+}
+
+uint8 EEPROM_writePageAsync(TWI_Transaction *transaction, uint16 u16addr, const uint8 *data, uint8 length,
+		void (*callback)(TWI_Transaction *transaction))
+{
+    /* The device address counter rolls over inside the page */
+    if ((length == 0) || (length > EEPROM_PAGE_SIZE - (u16addr % EEPROM_PAGE_SIZE)))
+        return ERROR;
+
+    EEPROM_setupTransaction(transaction, u16addr, callback);
+    transaction->write_buffer = data;
+    transaction->write_length = length;
+
+    if (TWI_submit(transaction) == FALSE)
+        return ERROR;
+
+    /* The next blocking access polls for the write cycle of this page */
+    g_writeCyclePending = TRUE;
+
+    return SUCCESS;
+}
+
+uint8 EEPROM_readBlockAsync(TWI_Transaction *transaction, uint16 u16addr, uint8 *data, uint8 length,
+		void (*callback)(TWI_Transaction *transaction))
+{
+    if (length == 0)
+        return ERROR;
+
+    EEPROM_setupTransaction(transaction, u16addr, callback);
+    transaction->read_buffer = data;
+    transaction->read_length = length;
+
+    if (TWI_submit(transaction) == FALSE)
+        return ERROR;
+
+    return SUCCESS;
+}
@@ -15,6 +15,7 @@
 #define EXTERNAL_EEPROM_H_
 
 #include "std_types.h"
+#include "twi.h"
 
 /*******************************************************************************
  *                      Preprocessor Macros                                    *
@@ -22,11 +23,64 @@
 #define ERROR 0
 #define SUCCESS 1
 
+/* 24C16 memory: 2K bytes, written in pages of 16 bytes */
+#define EEPROM_SIZE                2048
+#define EEPROM_PAGE_SIZE           16
+
+/*
+ * The device does not acknowledge its address during the internal write cycle (tWR),
+ * so the end of the cycle is found by polling the address until it is acknowledged.
+ * Each trial takes around 50us, 500 trials bound the wait well above the 10ms maximum tWR.
+ */
+#define EEPROM_ACK_POLL_MAX_TRIES  500
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
 uint8 EEPROM_writeByte(uint16 u16addr,uint8 u8data);
 uint8 EEPROM_readByte(uint16 u16addr,uint8 *u8data);
+
+/*
+ * Description :
+ * Write a block of bytes starting from u16addr.
+ * The block is split at the page boundaries, each page is sent in one bus transaction.
+ * Returns as soon as the last page is sent, the next access waits for its write cycle.
+ */
+uint8 EEPROM_writeBlock(uint16 u16addr,const uint8 *data,uint16 length);
+
+/*
+ * Description :
+ * Read a block of bytes starting from u16addr in one sequential read transaction.
+ */
+uint8 EEPROM_readBlock(uint16 u16addr,uint8 *data,uint16 length);
+
+/*
+ * Description :
+ * Wait until the internal write cycle of the last write ends, by acknowledge polling.
+ * Returns at once if no write cycle is pending, and ERROR if the device does not
+ * answer within EEPROM_ACK_POLL_MAX_TRIES trials.
+ */
+uint8 EEPROM_waitWriteComplete(void);
+
+/*
+ * Description :
+ * Queue an asynchronous write of up to one page starting from u16addr and return at once.
+ * The transaction descriptor and the data should stay untouched until it completes,
+ * the callback (may be NULL_PTR) is called from the TWI ISR.
+ * Returns ERROR if the data crosses a page boundary or the descriptor is still in use.
+ */
+uint8 EEPROM_writePageAsync(TWI_Transaction *transaction,uint16 u16addr,const uint8 *data,uint8 length,
+		void (*callback)(TWI_Transaction *transaction));
+
+/*
+ * Description :
+ * Queue an asynchronous sequential read starting from u16addr and return at once.
+ * The transaction descriptor and the buffer should stay untouched until it completes,
+ * the callback (may be NULL_PTR) is called from the TWI ISR.
+ * Returns ERROR if the descriptor is still in use.
+ */
+uint8 EEPROM_readBlockAsync(TWI_Transaction *transaction,uint16 u16addr,uint8 *data,uint8 length,
+		void (*callback)(TWI_Transaction *transaction));
  
 #endif /* EXTERNAL_EEPROM_H_ */
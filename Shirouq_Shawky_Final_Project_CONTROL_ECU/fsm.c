@@ -0,0 +1,72 @@
+ /******************************************************************************
+ *
+ * Module: FSM
+ *
+ * File Name: fsm.c
+ *
+ * Description: Source file for the table driven state machine engine
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#include "fsm.h"
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void FSM_init(FSM_Machine *fsm, const FSM_Transition *table, uint8 table_size, FSM_State initial_state)
+{
+	fsm->table = table;
+	fsm->table_size = table_size;
+	fsm->state = initial_state;
+	fsm->pending = FSM_NO_EVENT;
+}
+
+boolean FSM_dispatch(FSM_Machine *fsm, FSM_Event event)
+{
+	FSM_Transition row;
+	uint8 index;
+	boolean handled = FALSE;
+
+	while(event != FSM_NO_EVENT)
+	{
+		for(index = 0; index < fsm->table_size; index++)
+		{
+			memcpy_P(&row, &fsm->table[index], sizeof(FSM_Transition));
+			if(((row.state == fsm->state) || (row.state == FSM_ANY_STATE)) && (row.event == event))
+			{
+				break;
+			}
+		}
+
+		if(index == fsm->table_size)
+		{
+			/* Ignored in this state */
+			break;
+		}
+		handled = TRUE;
+
+		fsm->pending = FSM_NO_EVENT;
+		if(row.action != NULL_PTR)
+		{
+			row.action();
+		}
+		if(row.next != FSM_SAME_STATE)
+		{
+			fsm->state = row.next;
+		}
+
+		/* Continue with the event posted by the action */
+		event = fsm->pending;
+	}
+
+	fsm->pending = FSM_NO_EVENT;
+	return handled;
+}
+
+void FSM_post(FSM_Machine *fsm, FSM_Event event)
+{
+	fsm->pending = event;
+}
@@ -0,0 +1,83 @@
+ /******************************************************************************
+ *
+ * Module: FSM
+ *
+ * File Name: fsm.h
+ *
+ * Description: Header file for the table driven state machine engine
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#ifndef FSM_H_
+#define FSM_H_
+
+#include "std_types.h"
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Table rows with this state match in any state */
+#define FSM_ANY_STATE          0xFF
+
+/* Table rows with this next state keep the current state */
+#define FSM_SAME_STATE         0xFF
+
+/* No event is pending */
+#define FSM_NO_EVENT           0xFF
+
+/* Fail the build if the condition is false, used for the RAM budgets */
+#define FSM_STATIC_ASSERT(condition, name)    typedef char fsm_assert_##name[(condition) ? 1 : -1]
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+typedef uint8 FSM_State;
+typedef uint8 FSM_Event;
+
+/* Transition row, the tables are kept in the flash with PROGMEM */
+typedef struct
+{
+	FSM_State state;
+	FSM_Event event;
+	void (*action)(void);   /* Can be NULL_PTR */
+	FSM_State next;
+}FSM_Transition;
+
+typedef struct
+{
+	const FSM_Transition *table;   /* PROGMEM table */
+	uint8 table_size;
+	FSM_State state;
+	FSM_Event pending;             /* Event posted by an action */
+}FSM_Machine;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Set the transitions table and the initial state of the machine.
+ */
+void FSM_init(FSM_Machine *fsm, const FSM_Transition *table, uint8 table_size, FSM_State initial_state);
+
+/*
+ * Description :
+ * Run the first transition matching the current state and the event, then the
+ * transitions of the events posted by its action. The actions run one after the other,
+ * never inside each other, so the stack depth does not grow with the events.
+ * Return FALSE if the event is ignored in the current state.
+ */
+boolean FSM_dispatch(FSM_Machine *fsm, FSM_Event event);
+
+/*
+ * Description :
+ * Post an event from an action, it is dispatched after the action returns.
+ */
+void FSM_post(FSM_Machine *fsm, FSM_Event event);
+
+#endif /* FSM_H_ */
@@ -0,0 +1,85 @@
+ /******************************************************************************
+ *
+ * Module: POWER
+ *
+ * File Name: power.c
+ *
+ * Description: Source file for the Idle sleep between events and its duty cycle statistics
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#include "power.h"
+#include "systick.h"
+#include <avr/io.h>
+#include <avr/sleep.h>
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+static uint32 g_startTick = 0;
+static uint32 g_wakeups = 0;
+static uint32 g_sleepTicks = 0;
+
+/* Sleep time less than one tick, carried to the next sleep */
+static uint32 g_sleepCounts = 0;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void POWER_init(void)
+{
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	POWER_resetStats();
+}
+
+void POWER_idle(void)
+{
+	uint32 start;
+
+	start = SysTick_getCounts();
+
+	/* SEI delays the interrupts by one instruction, so the CPU sleeps before any of them runs */
+	sleep_enable();
+	sei();
+	sleep_cpu();
+	sleep_disable();
+
+	/* The interrupt that woke the CPU has already run */
+	g_sleepCounts += SysTick_getCounts() - start;
+	g_sleepTicks += g_sleepCounts / SYSTICK_COUNTS_PER_TICK;
+	g_sleepCounts %= SYSTICK_COUNTS_PER_TICK;
+	g_wakeups++;
+}
+
+void POWER_getStats(POWER_Stats *stats)
+{
+	stats->wakeups = g_wakeups;
+	stats->sleep_time = g_sleepTicks;
+	stats->total_time = SysTick_getTicks() - g_startTick;
+}
+
+uint8 POWER_getDutyCycle(void)
+{
+	uint32 total = SysTick_getTicks() - g_startTick;
+	uint32 sleep;
+
+	if(total < 100)
+	{
+		return 100;
+	}
+
+	/* Divide the total first so the sleep time can't overflow */
+	sleep = g_sleepTicks / (total / 100);
+	return (sleep >= 100) ? 0 : (uint8)(100 - sleep);
+}
+
+void POWER_resetStats(void)
+{
+	g_startTick = SysTick_getTicks();
+	g_wakeups = 0;
+	g_sleepTicks = 0;
+	g_sleepCounts = 0;
+}
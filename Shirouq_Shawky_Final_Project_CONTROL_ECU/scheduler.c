@@ -0,0 +1,142 @@
+ /******************************************************************************
+ *
+ * Module: SCHEDULER
+ *
+ * File Name: scheduler.c
+ *
+ * Description: Source file for the cooperative run-to-completion task scheduler
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#include "scheduler.h"
+#include "systick.h"
+#include "power.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+static Scheduler_TaskHandler g_handlers[SCHEDULER_MAX_TASKS];
+
+/* Pending events of every task, set by the interrupts */
+static volatile uint8 g_events[SCHEDULER_MAX_TASKS];
+
+/* Bit for every task with pending events, the lowest set bit is the next task */
+static volatile uint8 g_readyTasks = 0;
+
+static Scheduler_TaskStats g_stats[SCHEDULER_MAX_TASKS];
+static uint32 g_idleTime = 0;
+static uint32 g_idleStart = 0;
+static boolean g_idle = FALSE;
+
+#if (SCHEDULER_MAX_TASKS > 8)
+#error "The ready tasks bits hold 8 tasks only"
+#endif
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+boolean Scheduler_addTask(uint8 task_id, Scheduler_TaskHandler handler)
+{
+	if((task_id >= SCHEDULER_MAX_TASKS) || (g_handlers[task_id] != NULL_PTR) || (handler == NULL_PTR))
+	{
+		return FALSE;
+	}
+	g_handlers[task_id] = handler;
+	return TRUE;
+}
+
+void Scheduler_postEvent(uint8 task_id, uint8 events)
+{
+	uint8 sreg = SREG;
+
+	if((task_id >= SCHEDULER_MAX_TASKS) || (events == 0))
+	{
+		return;
+	}
+
+	cli();
+	g_events[task_id] |= events;
+	g_readyTasks |= (uint8)(1 << task_id);
+	SREG = sreg;
+}
+
+boolean Scheduler_dispatch(void)
+{
+	uint8 task_id;
+	uint8 events;
+	uint8 sreg;
+	uint32 start, time;
+
+	if(g_readyTasks == 0)
+	{
+		if(g_idle == FALSE)
+		{
+			g_idle = TRUE;
+			g_idleStart = SysTick_getCounts();
+		}
+		return FALSE;
+	}
+
+	start = SysTick_getCounts();
+	if(g_idle == TRUE)
+	{
+		g_idle = FALSE;
+		g_idleTime += start - g_idleStart;
+	}
+
+	/* Find the highest priority ready task */
+	for(task_id = 0; (g_readyTasks & (uint8)(1 << task_id)) == 0; task_id++);
+
+	/* Take its events, the new ones posted while it runs make it ready again */
+	sreg = SREG;
+	cli();
+	events = g_events[task_id];
+	g_events[task_id] = 0;
+	g_readyTasks &= (uint8)~(1 << task_id);
+	SREG = sreg;
+
+	if(g_handlers[task_id] != NULL_PTR)
+	{
+		g_handlers[task_id](events);
+
+		time = SysTick_getCounts() - start;
+		g_stats[task_id].runs++;
+		g_stats[task_id].total_time += time;
+		if(time > g_stats[task_id].max_time)
+		{
+			g_stats[task_id].max_time = time;
+		}
+	}
+
+	return TRUE;
+}
+
+void Scheduler_run(void)
+{
+	while(1)
+	{
+		if(Scheduler_dispatch() == FALSE)
+		{
+			/* Sleep until an interrupt posts an event */
+			POWER_WAIT_WHILE(g_readyTasks == 0);
+		}
+	}
+}
+
+void Scheduler_getTaskStats(uint8 task_id, Scheduler_TaskStats *stats)
+{
+	if(task_id < SCHEDULER_MAX_TASKS)
+	{
+		*stats = g_stats[task_id];
+	}
+}
+
+uint32 Scheduler_getIdleTime(void)
+{
+	return g_idleTime;
+}
@@ -0,0 +1,83 @@
+ /******************************************************************************
+ *
+ * Module: SCHEDULER
+ *
+ * File Name: scheduler.h
+ *
+ * Description: Header file for the cooperative run-to-completion task scheduler
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* The task ID is also its priority, task 0 has the highest priority */
+#define SCHEDULER_MAX_TASKS        8
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* Called with the pending events of the task, it should return without waiting */
+typedef void (*Scheduler_TaskHandler)(uint8 events);
+
+/* Runtime of a task in SysTick counts (SYSTICK_COUNT_US each) */
+typedef struct
+{
+	uint32 runs;
+	uint32 total_time;
+	uint32 max_time;
+}Scheduler_TaskStats;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Add the task with the required ID, return FALSE if the ID is not valid or used.
+ */
+boolean Scheduler_addTask(uint8 task_id, Scheduler_TaskHandler handler);
+
+/*
+ * Description :
+ * Add the events to the pending events of the task.
+ * It can be called from the interrupts, the same events posted twice are handled once.
+ */
+void Scheduler_postEvent(uint8 task_id, uint8 events);
+
+/*
+ * Description :
+ * Run the highest priority task with pending events.
+ * Return FALSE if there was nothing to run.
+ */
+boolean Scheduler_dispatch(void);
+
+/*
+ * Description :
+ * Dispatch the tasks forever, the CPU sleeps in Idle while there are no events.
+ * The power module should be initialized.
+ */
+void Scheduler_run(void);
+
+/*
+ * Description :
+ * Copy the runtime statistics of the task.
+ */
+void Scheduler_getTaskStats(uint8 task_id, Scheduler_TaskStats *stats);
+
+/*
+ * Description :
+ * Return the time spent without any pending event in SysTick counts.
+ */
+uint32 Scheduler_getIdleTime(void);
+
+#endif /* SCHEDULER_H_ */
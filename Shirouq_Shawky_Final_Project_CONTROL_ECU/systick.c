@@ -0,0 +1,223 @@
+ /******************************************************************************
+ *
+ * Module: SYSTICK
+ *
+ * File Name: systick.c
+ *
+ * Description: Source file for the system tick and the software timers built on Timer1
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#include "systick.h"
+#include "timer1.h"
+#include "common_macros.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+static volatile uint32 g_ticks = 0;
+
+/* Timer wheel, every bucket is a list of the timers expiring on its ticks */
+static SysTick_Timer *g_wheel[SYSTICK_WHEEL_SIZE];
+static uint8 g_activeTimers = 0;
+
+/* The tick can stop while no timer is active, and it is stopped now */
+static volatile boolean g_tickless = FALSE;
+static volatile boolean g_stopped = FALSE;
+
+static const Timer1_ConfigType g_timer1Configuration = { 0, SYSTICK_COMPARE_VALUE, F_CPU_CLOCK_64, COMPARE_MODE };
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* Called by Timer1 on every tick */
+static void SysTick_tickHandler(void);
+
+/* Add the timer to the bucket of its expiry, interrupts should be disabled */
+static void SysTick_insert(SysTick_Timer *timer);
+
+/* Remove the timer from its bucket, interrupts should be disabled */
+static void SysTick_remove(SysTick_Timer *timer);
+
+/* Start Timer1 again if the tick is stopped, interrupts should be disabled */
+static void SysTick_restart(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+static void SysTick_insert(SysTick_Timer *timer)
+{
+	uint8 bucket = (uint8)(timer->expiry & (SYSTICK_WHEEL_SIZE - 1));
+
+	timer->next = g_wheel[bucket];
+	g_wheel[bucket] = timer;
+	timer->active = TRUE;
+	g_activeTimers++;
+}
+
+static void SysTick_remove(SysTick_Timer *timer)
+{
+	uint8 bucket = (uint8)(timer->expiry & (SYSTICK_WHEEL_SIZE - 1));
+	SysTick_Timer *previous = g_wheel[bucket];
+
+	if(previous == timer)
+	{
+		g_wheel[bucket] = timer->next;
+	}
+	else
+	{
+		while((previous != NULL_PTR) && (previous->next != timer))
+		{
+			previous = previous->next;
+		}
+		if(previous != NULL_PTR)
+		{
+			previous->next = timer->next;
+		}
+	}
+	timer->active = FALSE;
+	g_activeTimers--;
+}
+
+static void SysTick_restart(void)
+{
+	if(g_stopped)
+	{
+		g_stopped = FALSE;
+		Timer1_init(&g_timer1Configuration);
+	}
+}
+
+static void SysTick_tickHandler(void)
+{
+	SysTick_Timer *timer;
+	uint32 now = g_ticks + 1;
+	uint8 bucket = (uint8)(now & (SYSTICK_WHEEL_SIZE - 1));
+
+	g_ticks = now;
+
+	/*
+	 * The bucket also holds timers of the next rounds of the wheel.
+	 * The search starts again after every callback as it can change the lists.
+	 */
+	timer = g_wheel[bucket];
+	while(timer != NULL_PTR)
+	{
+		if(timer->expiry != now)
+		{
+			timer = timer->next;
+			continue;
+		}
+
+		SysTick_remove(timer);
+		if(timer->period != 0)
+		{
+			timer->expiry = now + timer->period;
+			SysTick_insert(timer);
+		}
+		if(timer->callback != NULL_PTR)
+		{
+			timer->callback(timer);
+		}
+		timer = g_wheel[bucket];
+	}
+
+	/* Nothing to count, the next timer started or SysTick_setTickless restarts the tick */
+	if(g_tickless && (g_activeTimers == 0))
+	{
+		Timer1_deInit();
+		g_stopped = TRUE;
+	}
+}
+
+void SysTick_init(void)
+{
+	Timer1_setCallBack(SysTick_tickHandler);
+	Timer1_init(&g_timer1Configuration);
+}
+
+void SysTick_setTickless(boolean enable)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	g_tickless = enable;
+	if(enable == FALSE)
+	{
+		SysTick_restart();
+	}
+	SREG = sreg;
+}
+
+uint32 SysTick_getTicks(void)
+{
+	uint32 ticks;
+	uint8 sreg = SREG;
+
+	/* The 4 bytes should not change while they are read */
+	cli();
+	ticks = g_ticks;
+	SREG = sreg;
+
+	return ticks;
+}
+
+uint32 SysTick_getCounts(void)
+{
+	uint32 ticks;
+	uint16 count;
+	uint8 sreg = SREG;
+
+	cli();
+	ticks = g_ticks;
+	count = TCNT1;
+
+	/* The counter was cleared on the compare match but its tick is not counted yet */
+	if(BIT_IS_SET(TIFR, OCF1A) && (count < SYSTICK_COMPARE_VALUE))
+	{
+		ticks++;
+	}
+	SREG = sreg;
+
+	return (ticks * SYSTICK_COUNTS_PER_TICK) + count;
+}
+
+void SysTick_startTimer(SysTick_Timer *timer, uint32 delay_ms, uint32 period_ms, SysTick_Callback callback)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	if(timer->active == TRUE)
+	{
+		SysTick_remove(timer);
+	}
+	timer->callback = callback;
+	timer->period = (period_ms == 0) ? 0 : SYSTICK_MS_TO_TICKS(period_ms);
+	timer->expiry = g_ticks + SYSTICK_MS_TO_TICKS(delay_ms);
+	SysTick_insert(timer);
+	SysTick_restart();
+	SREG = sreg;
+}
+
+void SysTick_stopTimer(SysTick_Timer *timer)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	if(timer->active == TRUE)
+	{
+		SysTick_remove(timer);
+	}
+	SREG = sreg;
+}
+
+boolean SysTick_isTimerActive(const SysTick_Timer *timer)
+{
+	return timer->active;
+}
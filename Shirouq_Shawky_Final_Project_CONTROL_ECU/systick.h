@@ -0,0 +1,117 @@
+ /******************************************************************************
+ *
+ * Module: SYSTICK
+ *
+ * File Name: systick.h
+ *
+ * Description: Header file for the system tick and the software timers built on Timer1
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#ifndef SYSTICK_H_
+#define SYSTICK_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Tick period in ms, Timer1 runs in compare mode with F_CPU/64 */
+#define SYSTICK_TICK_MS            1
+#define SYSTICK_PRESCALER          64
+#define SYSTICK_COMPARE_VALUE      ((uint16)(((F_CPU / SYSTICK_PRESCALER) * SYSTICK_TICK_MS) / 1000UL - 1))
+
+#if ((((F_CPU / SYSTICK_PRESCALER) * SYSTICK_TICK_MS) / 1000UL) > 65536UL)
+#error "The tick period does not fit in Timer1"
+#endif
+
+/* Number of buckets of the timer wheel, the timers are hashed by their expiry tick */
+#define SYSTICK_WHEEL_SIZE         8
+
+#if ((SYSTICK_WHEEL_SIZE & (SYSTICK_WHEEL_SIZE - 1)) != 0)
+#error "The timer wheel size should be a power of 2"
+#endif
+
+/* Timer1 counts in one tick, the timestamps of SysTick_getCounts use them as unit */
+#define SYSTICK_COUNTS_PER_TICK    ((uint32)SYSTICK_COMPARE_VALUE + 1)
+#define SYSTICK_COUNT_US           ((1000000UL * SYSTICK_PRESCALER) / F_CPU)
+
+/* Convert a time in ms to ticks, at least one tick */
+#define SYSTICK_MS_TO_TICKS(ms)    (((ms) < SYSTICK_TICK_MS) ? 1UL : ((uint32)(ms) / SYSTICK_TICK_MS))
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+typedef struct SysTick_Timer SysTick_Timer;
+
+/* Called from the Timer1 interrupt when the timer expires */
+typedef void (*SysTick_Callback)(SysTick_Timer *timer);
+
+/*
+ * Timer allocated by the caller, it should not be changed directly while it is active.
+ */
+struct SysTick_Timer
+{
+	uint32 expiry;              /* Tick of the next expiry */
+	uint32 period;              /* Reload in ticks, 0 for a one-shot timer */
+	SysTick_Callback callback;
+	volatile boolean active;  /* Changed by the tick interrupt */
+	SysTick_Timer *next;        /* Next timer in the same wheel bucket */
+};
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Start Timer1 to generate the system tick.
+ * Should be called once at startup with the global interrupts enabled.
+ */
+void SysTick_init(void);
+
+/*
+ * Description :
+ * Let the tick stop while no timer is active so the CPU is not woken every tick.
+ * Starting a timer or disabling it starts the tick again. The ticks are not counted
+ * while it is stopped, so SysTick_getTicks and SysTick_getCounts stand still.
+ */
+void SysTick_setTickless(boolean enable);
+
+/*
+ * Description :
+ * Return the number of ticks since the startup, the read is atomic.
+ */
+uint32 SysTick_getTicks(void);
+
+/*
+ * Description :
+ * Return a timestamp in Timer1 counts (SYSTICK_COUNT_US each) for measuring short
+ * durations, it wraps around so only the difference of two timestamps should be used.
+ */
+uint32 SysTick_getCounts(void);
+
+/*
+ * Description :
+ * Start the timer to expire after delay_ms then every period_ms, a zero period makes it
+ * a one-shot timer. An active timer is restarted.
+ * The callback runs in the interrupt context and can start or stop any timer.
+ */
+void SysTick_startTimer(SysTick_Timer *timer, uint32 delay_ms, uint32 period_ms, SysTick_Callback callback);
+
+/*
+ * Description :
+ * Stop the timer, nothing is done if it is not active.
+ */
+void SysTick_stopTimer(SysTick_Timer *timer);
+
+/*
+ * Description :
+ * Return TRUE if the timer is waiting for its expiry.
+ */
+boolean SysTick_isTimerActive(const SysTick_Timer *timer);
+
+#endif /* SYSTICK_H_ */
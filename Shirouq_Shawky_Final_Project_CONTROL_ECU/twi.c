@@ -12,7 +12,143 @@
  
 #include "twi.h"
 #include "common_macros.h"
+#include "power.h"
 #include <avr/io.h>
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Queue of asynchronous transactions, the head is the one on the bus */
+static TWI_Transaction * volatile g_queueHead = NULL_PTR;
+static TWI_Transaction * volatile g_queueTail = NULL_PTR;
+
+/* Progress of the head transaction */
+static uint8 g_writeIndex;       /* Bytes sent from sub address + write buffer */
+static uint8 g_readIndex;        /* Bytes received in the read buffer */
+static boolean g_readPhase;      /* SLA+R is sent after the next (repeated) START */
+static uint16 g_retries;         /* Address NACK retries left */
+static boolean g_inCallback = FALSE; /* A completion callback is running inside the ISR */
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* Prepare the progress variables for the head transaction */
+static void TWI_loadHead(void);
+
+/* Finish the head transaction with the required status and start the next one if any */
+static void TWI_finish(TWI_TransactionStatus status);
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+
+/* Each TWINT moves the head transaction one step according to the TWI status */
+ISR(TWI_vect)
+{
+	TWI_Transaction *t = g_queueHead;
+	uint8 total_write;
+
+	if(t == NULL_PTR)
+	{
+		/* Nothing to do, release the bus */
+		TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+		return;
+	}
+
+	total_write = t->sub_address_length + t->write_length;
+
+	switch(TWSR & 0xF8)
+	{
+	case TWI_START:
+	case TWI_REP_START:
+		/* Send the slave address with R/W=1 in the read phase, R/W=0 otherwise */
+		TWDR = (uint8)((t->address << 1) | (g_readPhase ? 1 : 0));
+		TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+		break;
+
+	case TWI_MT_SLA_W_ACK:
+	case TWI_MT_DATA_ACK:
+		if(g_writeIndex < total_write)
+		{
+			/* Sub address bytes first, then the write buffer */
+			if(g_writeIndex < t->sub_address_length)
+			{
+				TWDR = t->sub_address[g_writeIndex];
+			}
+			else
+			{
+				TWDR = t->write_buffer[g_writeIndex - t->sub_address_length];
+			}
+			g_writeIndex++;
+			TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+		}
+		else if(t->read_length > 0)
+		{
+			/* Repeated START to switch to the read phase */
+			g_readPhase = TRUE;
+			TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+		}
+		else
+		{
+			TWI_finish(TWI_TRANSACTION_DONE);
+		}
+		break;
+
+	case TWI_MT_SLA_W_NACK:
+	case TWI_MR_SLA_R_NACK:
+		if(g_retries > 0)
+		{
+			/* Slave busy (e.g. EEPROM write cycle), poll its address again from the beginning */
+			g_retries--;
+			g_writeIndex = 0;
+			g_readPhase = (total_write == 0) ? TRUE : FALSE;
+			TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+		}
+		else
+		{
+			TWI_finish(TWI_TRANSACTION_NACK);
+		}
+		break;
+
+	case TWI_MT_SLA_R_ACK:
+		/* ACK the coming byte only if it is not the last one */
+		if(t->read_length > 1)
+		{
+			TWCR = (1 << TWINT) | (1 << TWEA) | (1 << TWEN) | (1 << TWIE);
+		}
+		else
+		{
+			TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+		}
+		break;
+
+	case TWI_MR_DATA_ACK:
+		t->read_buffer[g_readIndex++] = TWDR;
+		if((t->read_length - g_readIndex) > 1)
+		{
+			TWCR = (1 << TWINT) | (1 << TWEA) | (1 << TWEN) | (1 << TWIE);
+		}
+		else
+		{
+			TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+		}
+		break;
+
+	case TWI_MR_DATA_NACK:
+		/* Last byte received */
+		t->read_buffer[g_readIndex++] = TWDR;
+		TWI_finish(TWI_TRANSACTION_DONE);
+		break;
+
+	default:
+		/* Data NACK, arbitration lost or bus error */
+		TWI_finish(TWI_TRANSACTION_ERROR);
+		break;
+	}
+}
 
 void TWI_init(const TWI_ConfigType *config_ptr)
 {
@@ -28,6 +164,11 @@ void TWI_init(const TWI_ConfigType *config_ptr)
 
 void TWI_start(void)
 {
+    /* Let the asynchronous transactions finish before using the bus, the TWI interrupt wakes the CPU */
+    POWER_WAIT_WHILE(g_queueHead != NULL_PTR);
+    /* and the last STOP to be sent */
+    while(BIT_IS_SET(TWCR,TWSTO));
+
     /* 
 	 * Clear the TWINT flag before sending the start bit TWINT=1
 	 * send the start bit by TWSTA=1
@@ -96,3 +237,102 @@ uint8 TWI_getStatus(void)
     status = TWSR & 0xF8;
     return status;
 }
+
+static void TWI_loadHead(void)
+{
+	TWI_Transaction *t = g_queueHead;
+
+	t->status = TWI_TRANSACTION_BUSY;
+	g_writeIndex = 0;
+	g_readIndex = 0;
+	g_retries = t->address_retries;
+	/* Pure read transactions start directly with SLA+R */
+	g_readPhase = ((t->sub_address_length + t->write_length) == 0) ? TRUE : FALSE;
+}
+
+static void TWI_finish(TWI_TransactionStatus status)
+{
+	TWI_Transaction *t = g_queueHead;
+
+	g_queueHead = t->next;
+	if(g_queueHead == NULL_PTR)
+	{
+		g_queueTail = NULL_PTR;
+	}
+	t->next = NULL_PTR;
+	t->status = status;
+
+	/* The callback may submit a new transaction, it is appended to the queue */
+	if(t->callback != NULL_PTR)
+	{
+		g_inCallback = TRUE;
+		t->callback(t);
+		g_inCallback = FALSE;
+	}
+
+	if(g_queueHead != NULL_PTR)
+	{
+		/* STOP then START for the next transaction */
+		TWI_loadHead();
+		TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+	}
+	else
+	{
+		TWCR = (1 << TWINT) | (1 << TWSTO) | (1 << TWEN);
+	}
+}
+
+boolean TWI_submit(TWI_Transaction *transaction)
+{
+	uint8 sreg = SREG;
+	boolean start_now;
+
+	/* The queue is shared with the ISR */
+	cli();
+
+	if((transaction->status == TWI_TRANSACTION_QUEUED) || (transaction->status == TWI_TRANSACTION_BUSY))
+	{
+		SREG = sreg;
+		return FALSE;
+	}
+
+	/* A transaction should write or read something */
+	if(((transaction->sub_address_length + transaction->write_length) == 0) && (transaction->read_length == 0))
+	{
+		SREG = sreg;
+		return FALSE;
+	}
+
+	transaction->status = TWI_TRANSACTION_QUEUED;
+	transaction->next = NULL_PTR;
+
+	start_now = (g_queueHead == NULL_PTR) ? TRUE : FALSE;
+	if(start_now)
+	{
+		g_queueHead = transaction;
+	}
+	else
+	{
+		g_queueTail->next = transaction;
+	}
+	g_queueTail = transaction;
+
+	/* When submitted from a completion callback, the ISR starts it after the STOP */
+	if(start_now && (g_inCallback == FALSE))
+	{
+		/* The STOP of the last transaction may still be on the bus */
+		while(BIT_IS_SET(TWCR,TWSTO));
+
+		/* Bus is free, send the START and let the ISR do the rest */
+		TWI_loadHead();
+		TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+	}
+
+	SREG = sreg;
+	return TRUE;
+}
+
+boolean TWI_isIdle(void)
+{
+	return (g_queueHead == NULL_PTR) ? TRUE : FALSE;
+}
@@ -23,8 +23,12 @@
 #define TWI_START         0x08 /* start has been sent */
 #define TWI_REP_START     0x10 /* repeated start */
 #define TWI_MT_SLA_W_ACK  0x18 /* Master transmit ( slave address + Write request ) to slave + ACK received from slave. */
+#define TWI_MT_SLA_W_NACK 0x20 /* Master transmit ( slave address + Write request ) to slave + NACK received from slave. */
 #define TWI_MT_SLA_R_ACK  0x40 /* Master transmit ( slave address + Read request ) to slave + ACK received from slave. */
 #define TWI_MT_DATA_ACK   0x28 /* Master transmit data and ACK has been received from Slave. */
+#define TWI_MT_DATA_NACK  0x30 /* Master transmit data and NACK has been received from Slave. */
+#define TWI_ARB_LOST      0x38 /* Arbitration lost in slave address or data bytes. */
+#define TWI_MR_SLA_R_NACK 0x48 /* Master transmit ( slave address + Read request ) to slave + NACK received from slave. */
 #define TWI_MR_DATA_ACK   0x50 /* Master received data and send ACK to slave. */
 #define TWI_MR_DATA_NACK  0x58 /* Master received data but doesn't send ACK to slave. */
 
@@ -56,6 +60,37 @@ typedef struct{
  TWI_BaudRate bit_rate;
 }TWI_ConfigType;
 
+typedef enum
+{
+	TWI_TRANSACTION_IDLE,  /* Never submitted */
+	TWI_TRANSACTION_QUEUED,/* Waiting for the transactions before it */
+	TWI_TRANSACTION_BUSY,  /* On the bus now */
+	TWI_TRANSACTION_DONE,  /* Completed successfully */
+	TWI_TRANSACTION_NACK,  /* The slave did not acknowledge its address after all the retries */
+	TWI_TRANSACTION_ERROR  /* Data NACK, arbitration lost or bus error */
+}TWI_TransactionStatus;
+
+/*
+ * Descriptor of an asynchronous master transaction:
+ * START, SLA+W, sub address bytes, write buffer, then if there is something to read
+ * Repeated START, SLA+R, read buffer, and finally STOP.
+ * The descriptor and its buffers are owned by the driver from TWI_submit until it completes.
+ */
+typedef struct TWI_Transaction
+{
+	uint8 address;                 /* 7-bit slave address */
+	uint8 sub_address[2];          /* Sent first in the write phase, e.g. the memory location address */
+	uint8 sub_address_length;
+	const uint8 *write_buffer;
+	uint8 write_length;
+	uint8 *read_buffer;
+	uint8 read_length;
+	uint16 address_retries;        /* Times to retry when the slave NACKs its address (acknowledge polling) */
+	void (*callback)(struct TWI_Transaction *transaction); /* Called from the ISR on completion, or NULL_PTR */
+	volatile TWI_TransactionStatus status;
+	struct TWI_Transaction *next;  /* Queue link, used by the driver only */
+}TWI_Transaction;
+
 
 
 /*******************************************************************************
@@ -69,5 +104,19 @@ uint8 TWI_readByteWithACK(void);
 uint8 TWI_readByteWithNACK(void);
 uint8 TWI_getStatus(void);
 
+/*
+ * Description :
+ * Queue an asynchronous transaction and return at once, it starts as soon as the bus is free.
+ * Completion is signalled by the transaction callback or by polling its status.
+ * Return FALSE if the transaction is already queued or running, or has nothing to write or read.
+ */
+boolean TWI_submit(TWI_Transaction *transaction);
+
+/*
+ * Description :
+ * Return TRUE if no asynchronous transaction is queued or running.
+ */
+boolean TWI_isIdle(void);
+
 
 #endif /* TWI_H_ */
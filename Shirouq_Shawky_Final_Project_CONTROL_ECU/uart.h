@@ -5,6 +5,65 @@
 
 #include "std_types.h"
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Ring buffers sizes, each one should be a power of 2 and not greater than 256 */
+#define UART_RX_BUFFER_SIZE 32
+#define UART_TX_BUFFER_SIZE 32
+
+#if((UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) != 0) || (UART_RX_BUFFER_SIZE > 256)
+
+#error "UART_RX_BUFFER_SIZE should be a power of 2 and not greater than 256"
+
+#endif
+
+#if((UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) != 0) || (UART_TX_BUFFER_SIZE > 256)
+
+#error "UART_TX_BUFFER_SIZE should be a power of 2 and not greater than 256"
+
+#endif
+
+/* Baud rate of the HMI <-> CONTROL link, both ECUs should use the same value */
+#define UART_LINK_BAUD_RATE 250000UL
+
+/* Maximum accepted difference between the required and the generated baud rate in per mille */
+#define UART_MAX_BAUD_ERROR 20
+
+/*
+ * Compile time baud rate calculations, the baud should be a constant so the whole
+ * expression is folded by the compiler (no runtime division).
+ * UBRR is rounded to the nearest value in both normal (U2X=0) and double speed (U2X=1) modes,
+ * the error is |F_CPU - divider * (UBRR + 1) * baud| / (divider * (UBRR + 1) * baud) in per mille.
+ */
+#define UART_UBRR_1X(baud) (((F_CPU) + 8UL * (baud)) / (16UL * (baud)) - 1UL)
+#define UART_UBRR_2X(baud) (((F_CPU) + 4UL * (baud)) / (8UL * (baud)) - 1UL)
+
+#define UART_BAUD_ERROR_CALC(divider, ubrr, baud) \
+	((((ubrr) + 1ULL) == 0) ? 1000ULL : \
+	 ((((F_CPU) > (divider) * ((ubrr) + 1ULL) * (baud)) ? \
+	   ((F_CPU) - (divider) * ((ubrr) + 1ULL) * (baud)) : \
+	   ((divider) * ((ubrr) + 1ULL) * (baud) - (F_CPU))) * 1000ULL) / \
+	  ((divider) * ((ubrr) + 1ULL) * (baud)))
+
+#define UART_BAUD_ERROR_1X(baud) UART_BAUD_ERROR_CALC(16ULL, UART_UBRR_1X(baud), (baud))
+#define UART_BAUD_ERROR_2X(baud) UART_BAUD_ERROR_CALC(8ULL, UART_UBRR_2X(baud), (baud))
+
+/* Use double speed only if it is more accurate, normal mode samples each bit more times */
+#define UART_USE_2X(baud) (UART_BAUD_ERROR_2X(baud) < UART_BAUD_ERROR_1X(baud))
+#define UART_UBRR(baud) (UART_USE_2X(baud) ? UART_UBRR_2X(baud) : UART_UBRR_1X(baud))
+#define UART_BAUD_ERROR(baud) (UART_USE_2X(baud) ? UART_BAUD_ERROR_2X(baud) : UART_BAUD_ERROR_1X(baud))
+
+/* The rate can be generated from F_CPU within UART_MAX_BAUD_ERROR and fits the 12-bit UBRR register */
+#define UART_BAUD_SUPPORTED(baud) ((UART_BAUD_ERROR(baud) <= UART_MAX_BAUD_ERROR) && (UART_UBRR(baud) <= 4095UL))
+
+#if !UART_BAUD_SUPPORTED(UART_LINK_BAUD_RATE)
+
+#error "UART_LINK_BAUD_RATE can not be generated from F_CPU within UART_MAX_BAUD_ERROR"
+
+#endif
+
 /*******************************************************************************
  *                      Data types                                  *
  *******************************************************************************/
@@ -22,8 +81,9 @@ typedef enum {
 
 typedef enum {
 	BAUD_RATE_10=10,BAUD_RATE_300=300,BAUD_RATE_600=600,BAUD_RATE_2400=2400,BAUD_RATE_4800=4800,
-	BAUD_RATE_9600=9600,BAUD_RATE_14400=14400,BAUD_RATE_19200=19200,BAUD_RATE_38400=38400,BAUD_RATE_57600=57600,
-	BAUD_RATE_115200=115200,BAUD_RATE_128000=128000,BAUD_RATE_256000=256000
+	BAUD_RATE_9600=9600,BAUD_RATE_14400=14400,BAUD_RATE_19200=19200,BAUD_RATE_28800=28800,BAUD_RATE_38400=38400,
+	BAUD_RATE_57600=57600,BAUD_RATE_76800=76800,BAUD_RATE_115200=115200,BAUD_RATE_128000=128000,
+	BAUD_RATE_250000=250000,BAUD_RATE_256000=256000
 }UART_BaudRate;
 
 
@@ -43,23 +103,47 @@ typedef struct{
  * Description :
  * Functional responsible for Initialize the UART device by:
  * 1. Setup the Frame format like number of data bits, parity bit type and number of stop bits.
- * 2. Enable the UART.
- * 3. Setup the UART baud rate.
+ * 2. Enable the UART and its RX Complete interrupt.
+ * 3. Setup the UART baud rate from the compile time table, a rate that can not be generated
+ *    from F_CPU within UART_MAX_BAUD_ERROR falls back to UART_LINK_BAUD_RATE.
+ * Global interrupts should be enabled for the driver to receive and send.
  */
 void UART_init(const UART_ConfigType * Config_Ptr);
 
 /*
  * Description :
  * Functional responsible for send byte to another UART device.
+ * The byte is queued in the Tx ring buffer, only waits if the buffer is full.
  */
 void UART_sendByte(const uint8 data);
 
 /*
  * Description :
  * Functional responsible for receive byte from another UART device.
+ * Waits until a byte is available in the Rx ring buffer.
  */
 uint8 UART_recieveByte(void);
 
+/*
+ * Description :
+ * Read one byte from the Rx ring buffer without waiting.
+ * Return TRUE and the byte in data if there was one, or FALSE if the buffer is empty.
+ */
+boolean UART_tryReceive(uint8 *data);
+
+/*
+ * Description :
+ * Return the number of received bytes waiting in the Rx ring buffer.
+ */
+uint8 UART_available(void);
+
+/*
+ * Description :
+ * Queue up to length bytes in the Tx ring buffer without waiting.
+ * Return the number of bytes actually queued, the rest did not fit in the buffer.
+ */
+uint8 UART_writeBuffer(const uint8 *data, uint8 length);
+
 /*
  * Description :
  * Send the required string through UART to the other UART device.
@@ -72,4 +156,11 @@ void UART_sendString(const uint8 *Str);
  */
 void UART_receiveString(uint8 *Str); // Receive until #
 
+/*
+ * Description :
+ * Set the function called from the RX Complete ISR after every received byte,
+ * it runs in the interrupt context.
+ */
+void UART_setRxCallBack(void(*a_ptr)(void));
+
 #endif /* UART_H_ */
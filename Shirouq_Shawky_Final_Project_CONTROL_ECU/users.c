@@ -0,0 +1,283 @@
+ /******************************************************************************
+ *
+ * Module: USERS
+ *
+ * File Name: users.c
+ *
+ * Description: Source file for the hashed table of user codes in the external EEPROM
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#include "users.h"
+#include "twi.h"
+#include "crc.h"
+#include "power.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Offsets inside a slot */
+#define SLOT_STATE_INDEX    0
+#define SLOT_ID_INDEX       1
+#define SLOT_CODE_INDEX     2
+#define SLOT_CRC_INDEX      (USERS_SLOT_SIZE - 1)
+
+/* Slot states in the EEPROM, anything else with a bad CRC is an empty slot */
+#define SLOT_STATE_USED     0xA5
+#define SLOT_STATE_DELETED  0x5A
+
+/* RAM tags, the tags of the used slots are never less than TAG_FIRST_USED */
+#define TAG_EMPTY           0x00
+#define TAG_DELETED         0x01
+#define TAG_FIRST_USED      0x02
+
+#define SLOT_ADDRESS(slot)  (USERS_TABLE_START + ((uint16)(slot) * USERS_SLOT_SIZE))
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* RAM index of the table */
+static uint8 g_tags[USERS_SLOT_COUNT];
+static uint8 g_ids[USERS_SLOT_COUNT];
+static uint8 g_usersCount = 0;
+
+/* Slot being written, kept until its write completes */
+static uint8 g_writeSlot[USERS_SLOT_SIZE];
+static TWI_Transaction g_writeTransaction;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* Calculate the home slot and the RAM tag of a code */
+static void USERS_hash(const uint8 *code, uint8 *home, uint8 *tag);
+
+/* Return the slot holding the code or USERS_NO_SLOT */
+static uint8 USERS_find(const uint8 *code);
+
+/* Return the used slot of the ID or USERS_NO_SLOT */
+static uint8 USERS_findId(uint8 id);
+
+/* Write a slot to the EEPROM in the background */
+static uint8 USERS_writeSlot(uint8 slot, uint8 state, uint8 id, const uint8 *code);
+
+/* Mark a used slot as deleted */
+static uint8 USERS_deleteSlot(uint8 slot);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+static void USERS_hash(const uint8 *code, uint8 *home, uint8 *tag)
+{
+	uint8 i;
+	uint8 reversed = 0;
+
+	*home = CRC8_compute(code, USERS_CODE_LENGTH) & (USERS_SLOT_COUNT - 1);
+
+	/* The tag uses the digits in the reverse order so it does not depend on the home slot */
+	for(i = USERS_CODE_LENGTH; i > 0; i--)
+	{
+		reversed = CRC8_update(reversed, code[i - 1]);
+	}
+	*tag = (reversed < TAG_FIRST_USED) ? (reversed + TAG_FIRST_USED) : reversed;
+}
+
+static uint8 USERS_find(const uint8 *code)
+{
+	uint8 slot_data[USERS_SLOT_SIZE];
+	uint8 home, tag, slot;
+	uint8 probe, i;
+	uint8 difference;
+
+	USERS_hash(code, &home, &tag);
+
+	for(probe = 0; probe < USERS_SLOT_COUNT; probe++)
+	{
+		slot = (home + probe) & (USERS_SLOT_COUNT - 1);
+
+		if(g_tags[slot] == TAG_EMPTY)
+		{
+			/* The code was never inserted after this slot */
+			break;
+		}
+		if(g_tags[slot] != tag)
+		{
+			continue;
+		}
+
+		/* Only the slots with a matching tag are read from the EEPROM */
+		if(EEPROM_readBlock(SLOT_ADDRESS(slot), slot_data, USERS_SLOT_SIZE) != SUCCESS)
+		{
+			continue;
+		}
+		if((slot_data[SLOT_STATE_INDEX] != SLOT_STATE_USED) ||
+				(CRC8_compute(slot_data, SLOT_CRC_INDEX) != slot_data[SLOT_CRC_INDEX]))
+		{
+			continue;
+		}
+
+		/* Check all the digits even after a mismatch */
+		difference = 0;
+		for(i = 0; i < USERS_CODE_LENGTH; i++)
+		{
+			difference |= (uint8)(slot_data[SLOT_CODE_INDEX + i] ^ code[i]);
+		}
+		if(difference == 0)
+		{
+			return slot;
+		}
+	}
+
+	return USERS_NO_SLOT;
+}
+
+static uint8 USERS_findId(uint8 id)
+{
+	uint8 slot;
+
+	for(slot = 0; slot < USERS_SLOT_COUNT; slot++)
+	{
+		if((g_tags[slot] >= TAG_FIRST_USED) && (g_ids[slot] == id))
+		{
+			return slot;
+		}
+	}
+
+	return USERS_NO_SLOT;
+}
+
+static uint8 USERS_writeSlot(uint8 slot, uint8 state, uint8 id, const uint8 *code)
+{
+	uint8 i;
+
+	/* The previous slot should be on the EEPROM before its buffer is reused */
+	POWER_WAIT_WHILE((g_writeTransaction.status == TWI_TRANSACTION_QUEUED) ||
+			(g_writeTransaction.status == TWI_TRANSACTION_BUSY));
+
+	g_writeSlot[SLOT_STATE_INDEX] = state;
+	g_writeSlot[SLOT_ID_INDEX] = id;
+	for(i = 0; i < USERS_CODE_LENGTH; i++)
+	{
+		g_writeSlot[SLOT_CODE_INDEX + i] = (code == NULL_PTR) ? 0 : code[i];
+	}
+	g_writeSlot[SLOT_CRC_INDEX] = CRC8_compute(g_writeSlot, SLOT_CRC_INDEX);
+
+	return EEPROM_writePageAsync(&g_writeTransaction, SLOT_ADDRESS(slot),
+			g_writeSlot, USERS_SLOT_SIZE, NULL_PTR);
+}
+
+static uint8 USERS_deleteSlot(uint8 slot)
+{
+	if(USERS_writeSlot(slot, SLOT_STATE_DELETED, g_ids[slot], NULL_PTR) != SUCCESS)
+	{
+		return ERROR;
+	}
+	g_tags[slot] = TAG_DELETED;
+	g_usersCount--;
+	return SUCCESS;
+}
+
+void USERS_init(void)
+{
+	uint8 slot_data[USERS_SLOT_SIZE];
+	uint8 home;
+	uint8 slot;
+
+	g_usersCount = 0;
+
+	for(slot = 0; slot < USERS_SLOT_COUNT; slot++)
+	{
+		g_tags[slot] = TAG_EMPTY;
+
+		if((EEPROM_readBlock(SLOT_ADDRESS(slot), slot_data, USERS_SLOT_SIZE) != SUCCESS) ||
+				(CRC8_compute(slot_data, SLOT_CRC_INDEX) != slot_data[SLOT_CRC_INDEX]))
+		{
+			continue;
+		}
+
+		if(slot_data[SLOT_STATE_INDEX] == SLOT_STATE_USED)
+		{
+			USERS_hash(&slot_data[SLOT_CODE_INDEX], &home, &g_tags[slot]);
+			g_ids[slot] = slot_data[SLOT_ID_INDEX];
+			g_usersCount++;
+		}
+		else if(slot_data[SLOT_STATE_INDEX] == SLOT_STATE_DELETED)
+		{
+			/* Keep the probe chains through this slot */
+			g_tags[slot] = TAG_DELETED;
+		}
+	}
+}
+
+boolean USERS_verify(const uint8 *code)
+{
+	return (USERS_find(code) != USERS_NO_SLOT) ? TRUE : FALSE;
+}
+
+uint8 USERS_enroll(uint8 id, const uint8 *code)
+{
+	uint8 home, tag, slot;
+	uint8 old_slot;
+	uint8 probe;
+
+	slot = USERS_find(code);
+	if(slot != USERS_NO_SLOT)
+	{
+		/* The same code can not open for two users */
+		return (g_ids[slot] == id) ? SUCCESS : ERROR;
+	}
+
+	/* An enrolled user keeps the old code until the new one is written */
+	old_slot = USERS_findId(id);
+
+	USERS_hash(code, &home, &tag);
+
+	for(probe = 0; probe < USERS_SLOT_COUNT; probe++)
+	{
+		slot = (home + probe) & (USERS_SLOT_COUNT - 1);
+
+		/* The old slot on the probe chain of the new code is replaced in one write */
+		if((g_tags[slot] < TAG_FIRST_USED) || (slot == old_slot))
+		{
+			if(USERS_writeSlot(slot, SLOT_STATE_USED, id, code) != SUCCESS)
+			{
+				return ERROR;
+			}
+			g_tags[slot] = tag;
+			g_ids[slot] = id;
+			if(slot == old_slot)
+			{
+				return SUCCESS;
+			}
+			g_usersCount++;
+
+			/* Then the old code stops opening */
+			return (old_slot == USERS_NO_SLOT) ? SUCCESS : USERS_deleteSlot(old_slot);
+		}
+	}
+
+	/* Table is full */
+	return ERROR;
+}
+
+uint8 USERS_revoke(uint8 id)
+{
+	uint8 slot = USERS_findId(id);
+
+	if(slot == USERS_NO_SLOT)
+	{
+		return ERROR;
+	}
+
+	return USERS_deleteSlot(slot);
+}
+
+uint8 USERS_count(void)
+{
+	return g_usersCount;
+}
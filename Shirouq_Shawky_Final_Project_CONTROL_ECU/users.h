@@ -0,0 +1,87 @@
+ /******************************************************************************
+ *
+ * Module: USERS
+ *
+ * File Name: users.h
+ *
+ * Description: Header file for the hashed table of user codes in the external EEPROM
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#ifndef USERS_H_
+#define USERS_H_
+
+#include "std_types.h"
+#include "external_eeprom.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+#define USERS_CODE_LENGTH          5
+
+/*
+ * Open addressed table with linear probing, the home slot is given by the CRC-8 of the code.
+ * Every slot is kept in RAM as a one byte tag and the user ID, so a lookup only reads
+ * the EEPROM slot whose tag matches the entered code.
+ */
+#define USERS_TABLE_START          0x0100
+#define USERS_SLOT_COUNT           32
+
+/* Slot: state, user ID, code, CRC-8 of all the previous bytes */
+#define USERS_SLOT_SIZE            (USERS_CODE_LENGTH + 3)
+
+#define USERS_NO_SLOT              0xFF
+
+#if ((USERS_SLOT_COUNT & (USERS_SLOT_COUNT - 1)) != 0) || (USERS_SLOT_COUNT >= USERS_NO_SLOT)
+#error "The number of user slots should be a power of 2 less than 255"
+#endif
+
+#if ((EEPROM_PAGE_SIZE % USERS_SLOT_SIZE) != 0) || ((USERS_TABLE_START % USERS_SLOT_SIZE) != 0)
+#error "A user slot should never cross an EEPROM page"
+#endif
+
+#if ((USERS_TABLE_START + (USERS_SLOT_COUNT * USERS_SLOT_SIZE)) > EEPROM_SIZE)
+#error "The users table does not fit in the EEPROM"
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Read all the slots from the EEPROM and build the RAM index.
+ * Should be called once at startup after the TWI initialization.
+ */
+void USERS_init(void);
+
+/*
+ * Description :
+ * Return TRUE if the code belongs to an enrolled user.
+ */
+boolean USERS_verify(const uint8 *code);
+
+/*
+ * Description :
+ * Add a user with its code, an enrolled ID gets the new code and its old code is
+ * deleted only after the new one is written.
+ * Return ERROR if the table is full or the code is used by another user.
+ */
+uint8 USERS_enroll(uint8 id, const uint8 *code);
+
+/*
+ * Description :
+ * Remove the user with the required ID.
+ * Return ERROR if the user is not enrolled.
+ */
+uint8 USERS_revoke(uint8 id);
+
+/*
+ * Description :
+ * Return the number of enrolled users.
+ */
+uint8 USERS_count(void);
+
+#endif /* USERS_H_ */
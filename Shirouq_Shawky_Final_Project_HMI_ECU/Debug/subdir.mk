@@ -5,25 +5,43 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
 ../HMI.c \
+../crc.c \
+../fsm.c \
 ../gpio.c \
 ../keypad.c \
 ../lcd.c \
+../messages.c \
+../power.c \
+../protocol.c \
+../systick.c \
 ../timer1.c \
 ../uart.c 
 
 OBJS += \
 ./HMI.o \
+./crc.o \
+./fsm.o \
 ./gpio.o \
 ./keypad.o \
 ./lcd.o \
+./messages.o \
+./power.o \
+./protocol.o \
+./systick.o \
 ./timer1.o \
 ./uart.o 
 
 C_DEPS += \
 ./HMI.d \
+./crc.d \
+./fsm.d \
 ./gpio.d \
 ./keypad.d \
 ./lcd.d \
+./messages.d \
+./power.d \
+./protocol.d \
+./systick.d \
 ./timer1.d \
 ./uart.d 
 
@@ -32,7 +50,7 @@ C_DEPS += \
 %.o: ../%.c subdir.mk
 	@echo 'Building file: $<'
 	@echo 'Invoking: AVR Compiler'
-	avr-gcc -Wall -g2 -gstabs -O0 -fpack-struct -fshort-enums -ffunction-sections -fdata-sections -std=gnu99 -funsigned-char -funsigned-bitfields -mmcu=atmega32 -DF_CPU=8000000UL -MMD -MP -MF"$(@:%.o=%.d)" -MT"$@" -c -o "$@" "$<"
+	avr-gcc -Wall -g2 -gstabs -O0 -fpack-struct -fshort-enums -ffunction-sections -fdata-sections -fstack-usage -std=gnu99 -funsigned-char -funsigned-bitfields -mmcu=atmega32 -DF_CPU=8000000UL -MMD -MP -MF"$(@:%.o=%.d)" -MT"$@" -c -o "$@" "$<"
 	@echo 'Finished building: $<'
 	@echo ' '
 
@@ -5,9 +5,14 @@
  *      Author: Shorouk Shawky
  */
 #include "uart.h"
+#include "protocol.h"
 #include "lcd.h"
+#include "messages.h"
 #include "keypad.h"
-#include "timer1.h"
+#include "systick.h"
+#include "power.h"
+#include "pt.h"
+#include "fsm.h"
 #include "common_macros.h"
 #include"util/delay.h"
 #include"avr/interrupt.h"
@@ -15,305 +20,614 @@
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
-#define PASS_LENGTH  5
-#define OPEN_TIME 15
-#define HOLDING_TIME 3
-#define CLOSE_TIME 15
-#define DANGER_TIME 60
+#define PASS_LENGTH  PROTOCOL_PASS_LENGTH
+#define USER_ID_DIGITS 2
+/* Door and alarm times in ms, the same as the CONTROL ECU */
+#define OPEN_TIME 15000
+#define HOLDING_TIME 3000
+#define CLOSE_TIME 15000
+#define DANGER_TIME 60000
 #define ENTER_BUTTON 13
 #define NORMAL_DELAY 600
-#define KEY_DELAY    400
-#define UART_DELAY  50
-#define MAX_ERROR_TRIALS 2
+/* Time to wait for the CONTROL ECU before asking for its state again */
+#define CONNECT_RETRY_TIME 500
 
+/*
+ * Send every digit of the open door and change password entries as it is typed,
+ * so the CONTROL ECU has its verdict ready when Enter is pressed.
+ * The request is then sent with no payload.
+ */
+#define STREAM_PASSWORD 1
+
+#if STREAM_PASSWORD
+#define PASS_REQUEST_LENGTH 0
+#else
+#define PASS_REQUEST_LENGTH PASS_LENGTH
+#endif
+
+/* States of the UI machine, every state runs its thread until it ends with an event */
+#define UI_CREATE_PASS   0
+#define UI_OPTIONS       1
+#define UI_CHANGE_PASS   2
+#define UI_OPEN_DOOR     3
+#define UI_ENROLL        4
+#define UI_REVOKE        5
+#define UI_DOOR          6
+#define UI_ALARM         7
+#define UI_CONNECT       8
+
+/*
+ * Events of the UI machine: the status replied by the CONTROL ECU, the option keys
+ * and UI_DONE for the states with no result.
+ */
+#define UI_MATCH         PROTOCOL_STATUS_MATCH
+#define UI_MISMATCH      PROTOCOL_STATUS_MISMATCH
+#define UI_LOCKOUT       PROTOCOL_STATUS_LOCKOUT
+#define UI_REFUSED       PROTOCOL_STATUS_REFUSED
+#define UI_INVALID       PROTOCOL_STATUS_INVALID
+#define UI_DONE          0x10
+#define UI_NO_STATUS     0xFF
+#define UI_KEY_OPEN      '+'
+#define UI_KEY_CHANGE    '-'
+#define UI_KEY_ENROLL    '*'
+#define UI_KEY_REVOKE    '%'
+
+/* RAM available for the contexts of the threads and the state machine */
+#define UI_RAM_BUDGET    112
+
+/* Wait in a thread for the required time in ms using the UI timer */
+#define PT_WAIT_MS(pt, ms) \
+	do { \
+		SysTick_startTimer(&ui_ctx.timer, (ms), 0, NULL_PTR); \
+		PT_WAIT_WHILE((pt), SysTick_isTimerActive(&ui_ctx.timer)); \
+	} while(0)
+
+/* Receive digits from the keypad in a thread */
+#define PT_ENTER_DIGITS(pt, prompt, digits, count, masked) \
+	do { \
+		setupEntry((prompt), (digits), (count), (masked)); \
+		PT_SPAWN((pt), &entry_ctx.pt, enterDigits(&entry_ctx.pt)); \
+	} while(0)
+
+/* Receive the password of a request in a thread, streaming its digits if required */
+#define PT_ENTER_REQUEST_PASS(pt) \
+	do { \
+		setupEntry(MSG_ENTER_PASS, request_ctx.payload, PASS_LENGTH, TRUE); \
+		entry_ctx.streamed = STREAM_PASSWORD; \
+		PT_SPAWN((pt), &entry_ctx.pt, enterDigits(&entry_ctx.pt)); \
+	} while(0)
+
+/* Wait in a thread for the reply of the CONTROL ECU and store its status in flag */
+#define PT_RECEIVE_STATUS(pt) \
+	do { \
+		PT_WAIT_UNTIL((pt), takeStatus()); \
+	} while(0)
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* RAM of the UI machine, shared by all its states */
+typedef struct {
+	FSM_Machine fsm;
+	PT_Thread pt;            /* Thread of the current state */
+	uint8 event;             /* Event of the current state when its thread ends */
+	uint8 flag;
+	uint8 key;
+	PROTOCOL_Frame frame;
+	SysTick_Timer timer;
+} UiContext;
+
+/* RAM of the UI_CREATE_PASS state */
+typedef struct {
+	uint8 Password_1[PASS_LENGTH];
+	uint8 Password_2[PASS_LENGTH];
+} NewPassContext;
+
+/* RAM of the states sending a request, the largest is the enroll payload */
+typedef struct {
+	uint8 payload[PROTOCOL_USER_CODE_INDEX + PASS_LENGTH];
+	uint8 id_digits[USER_ID_DIGITS];
+} RequestContext;
+
+/* RAM of the digits entry thread */
+typedef struct {
+	PT_Thread pt;
+	PGM_P prompt;            /* Message in the flash */
+	uint8 *digits;
+	uint8 count;
+	uint8 index;
+	boolean masked;
+	boolean streamed;        /* Every digit is sent to the CONTROL ECU */
+} EntryContext;
 
 /****************************************************************
 *                            Global Variables
 ****************************************************************/
-uint8 Password_1[5];
-uint8 Password_2[5];
-uint8 flag;
-uint8 i;
-uint8 key;
 
-uint8 errorTrial = 0;
-volatile int TIMER1_g_ticks = 0;
+/*
+ * Every context is a section of its own (-fdata-sections) so its size is listed
+ * in the map file, and all of them should fit in the budget.
+ */
+UiContext ui_ctx;
+NewPassContext new_pass_ctx;
+RequestContext request_ctx;
+EntryContext entry_ctx;
+
+FSM_STATIC_ASSERT(sizeof(UiContext) + sizeof(NewPassContext) + sizeof(RequestContext) +
+		sizeof(EntryContext) <= UI_RAM_BUDGET, ui_contexts_ram);
 
 /*******************************************************************************
 *                      Functions prototypes                                   *
 *******************************************************************************/
-void createNewPass(void);
-void checkPass(void);
-void changePass(void);
-void showOptions(void);
-void openDoor(void);
-void turnOnBuzzer(void);
-void Callback(void);
-void turnOnMotor(void);
+void uiTask(void);
+PT_THREAD(enterDigits(PT_Thread *pt));
+PT_THREAD(createNewPass(PT_Thread *pt));
+PT_THREAD(showOptions(PT_Thread *pt));
+PT_THREAD(changePass(PT_Thread *pt));
+PT_THREAD(openDoor(PT_Thread *pt));
+PT_THREAD(enrollUser(PT_Thread *pt));
+PT_THREAD(revokeUser(PT_Thread *pt));
+PT_THREAD(turnOnBuzzer(PT_Thread *pt));
+PT_THREAD(turnOnMotor(PT_Thread *pt));
+PT_THREAD(connect(PT_Thread *pt));
+boolean takeKey(void);
+void setupEntry(PGM_P prompt, uint8 *digits, uint8 count, boolean masked);
+void sendDigit(void);
+boolean receiveStatus(void);
+boolean takeStatus(void);
+void storeUserId(void);
+
+/*******************************************************************************
+*                      Transition Tables                                      *
+*******************************************************************************/
+
+/* Thread of every UI state, in the order of the states */
+PT_THREAD((*const ui_threads[])(PT_Thread *pt)) PROGMEM = {
+	createNewPass, showOptions, changePass, openDoor, enrollUser, revokeUser, turnOnMotor, turnOnBuzzer,
+	connect
+};
+
+const FSM_Transition ui_table[] PROGMEM = {
+	/* state           event            action    next */
+	{ UI_CONNECT,      UI_MATCH,        NULL_PTR, UI_OPTIONS     },
+	{ UI_CONNECT,      UI_MISMATCH,     NULL_PTR, UI_CREATE_PASS },
+	{ UI_CREATE_PASS,  UI_MATCH,        NULL_PTR, UI_OPTIONS     },
+	{ UI_CREATE_PASS,  UI_MISMATCH,     NULL_PTR, UI_CREATE_PASS },
+	{ UI_CREATE_PASS,  UI_INVALID,      NULL_PTR, UI_CREATE_PASS },
+	{ UI_OPTIONS,      UI_KEY_OPEN,     NULL_PTR, UI_OPEN_DOOR   },
+	{ UI_OPTIONS,      UI_KEY_CHANGE,   NULL_PTR, UI_CHANGE_PASS },
+	{ UI_OPTIONS,      UI_KEY_ENROLL,   NULL_PTR, UI_ENROLL      },
+	{ UI_OPTIONS,      UI_KEY_REVOKE,   NULL_PTR, UI_REVOKE      },
+	{ UI_CHANGE_PASS,  UI_MATCH,        NULL_PTR, UI_CREATE_PASS },
+	{ UI_OPEN_DOOR,    UI_MATCH,        NULL_PTR, UI_DOOR        },
+	/* A wrong password is entered again, the CONTROL ECU limits the trials */
+	{ FSM_ANY_STATE,   UI_MISMATCH,     NULL_PTR, FSM_SAME_STATE },
+	{ FSM_ANY_STATE,   UI_LOCKOUT,      NULL_PTR, UI_ALARM       },
+	/* Everything else goes back to the options */
+	{ FSM_ANY_STATE,   UI_MATCH,        NULL_PTR, UI_OPTIONS     },
+	{ FSM_ANY_STATE,   UI_REFUSED,      NULL_PTR, UI_OPTIONS     },
+	{ FSM_ANY_STATE,   UI_INVALID,      NULL_PTR, UI_OPTIONS     },
+	{ FSM_ANY_STATE,   UI_DONE,         NULL_PTR, UI_OPTIONS     },
+};
+
 /****************************************************************
 *                            functions definitions
 ****************************************************************/
 
 int main (void){
 	sei();
+	SysTick_init();
+	POWER_init();
+	KEYPAD_init();
+
 	LCD_init();
-	UART_ConfigType uart_configuration = {BIT_DATA_8, DISABLE_PARITY, ONE_STOP_BIT, 9600 };
+	UART_ConfigType uart_configuration = {BIT_DATA_8, DISABLE_PARITY, ONE_STOP_BIT, UART_LINK_BAUD_RATE };
 	UART_init(&uart_configuration);
 
-	Timer1_setCallBack(Callback);
-	Timer1_ConfigType Timer1_configuration = { 0, 8000, F_CPU_CLOCK_1024, COMPARE_MODE };
-	Timer1_init(&Timer1_configuration);
+	FSM_init(&ui_ctx.fsm, ui_table, sizeof(ui_table) / sizeof(FSM_Transition), UI_CONNECT);
+	PT_INIT(&ui_ctx.pt);
 
-	createNewPass();
+	// Run the UI until it waits, then queue the changes of the frame buffer,
+	// SysTick sends them and scans the keypad in the background,
+	// and sleep until the next interrupt, the tick wakes the CPU at least every SYSTICK_TICK_MS
 	while(1){
-		showOptions();
+		uiTask();
+		LCD_flush();
+		cli();
+		POWER_idle();
 	}
 }
 
 /*
  * Description:
- * Function responsible for creating new passwords based on user input and confirming the new password.
+ * Function responsible for running the thread of the current UI state.
+ * When the thread ends its event moves the UI machine to the next state.
  */
-void createNewPass(void) {
-    LCD_clearScreen();
-    LCD_displayString("Plz Enter Pass:");
-    LCD_moveCursor(1, 0);
+void uiTask(void) {
+    PT_THREAD((*thread)(PT_Thread *pt));
 
-     i = key = 0;
-    flag = 1;
+    memcpy_P(&thread, &ui_threads[ui_ctx.fsm.state], sizeof(thread));
+    if (!PT_SCHEDULE(thread(&ui_ctx.pt))) {
+        FSM_dispatch(&ui_ctx.fsm, ui_ctx.event);
+        PT_INIT(&ui_ctx.pt);
 
-    // Loop to receive the user's input for the new password
-    for (i = 0; i < PASS_LENGTH; i++) {
-        key = KEYPAD_getPressedKey();
+        // Keys pressed while the last state showed its result are not for the next one
+        KEYPAD_clearEvents();
+    }
+}
 
-        // Check if the key pressed is a valid numeric key (0-9)
-        if (key >= 0 && key <= 9) {
-            LCD_displayCharacter('*'); // Display an asterisk to mask the input
-            Password_1[i] = key; // Store the entered digit in the password array
-            _delay_ms(KEY_DELAY); // Delay for stability
+/*
+ * Description:
+ * Helper Function responsible for taking the key pressed for the UI.
+ * Return FALSE if no key is pressed yet, the key is stored in ui_ctx.key.
+ */
+boolean takeKey(void) {
+    KEYPAD_Event event;
+
+    // Only the presses are used, the releases and long presses are dropped
+    while (KEYPAD_getEvent(&event)) {
+        if (event.type == KEYPAD_PRESS) {
+            ui_ctx.key = event.key;
+            return TRUE;
         }
     }
-    // Wait for the user to press the "Enter" button on the keypad
-    while (KEYPAD_getPressedKey() != ENTER_BUTTON);
+    return FALSE;
+}
 
-     // Send the first part of the new password via UART
-    for (i = 0; i < PASS_LENGTH; i++) {
-        UART_sendByte(Password_1[i]);
-        _delay_ms(UART_DELAY);
-    }
+/*
+ * Description:
+ * Helper Function responsible for setting the digits entry done by the enterDigits thread.
+ */
+void setupEntry(PGM_P prompt, uint8 *digits, uint8 count, boolean masked) {
+    entry_ctx.prompt = prompt;
+    entry_ctx.digits = digits;
+    entry_ctx.count = count;
+    entry_ctx.masked = masked;
+    entry_ctx.streamed = FALSE;
+}
 
+/*
+ * Description:
+ * Helper Function responsible for sending the last entered digit with its index.
+ */
+void sendDigit(void) {
+    uint8 payload[PROTOCOL_DIGIT_LENGTH];
 
-    // Clear the LCD and prompt the user to re-enter the password
-    LCD_clearScreen();
-    LCD_displayString("Plz reEnter Pass:");
-    LCD_moveCursor(1, 0);
+    payload[PROTOCOL_DIGIT_INDEX] = entry_ctx.index;
+    payload[PROTOCOL_DIGIT_VALUE] = entry_ctx.digits[entry_ctx.index];
+    PROTOCOL_sendFrame(PROTOCOL_MSG_PASS_DIGIT, payload, PROTOCOL_DIGIT_LENGTH);
+}
 
-    // Loop to receive the user's confirmation of the new password
-    for (i = 0; i < PASS_LENGTH; i++) {
-        key = KEYPAD_getPressedKey();
+/*
+ * Description:
+ * Thread responsible for receiving a number of digits from the keypad
+ * after showing the prompt, the digits are masked with asterisks if required.
+ * The digits are sent as they are typed for a streamed entry.
+ * It ends after the "Enter" button.
+ */
+PT_THREAD(enterDigits(PT_Thread *pt)) {
+    PT_BEGIN(pt);
+
+    LCD_bufferClear();
+    LCD_bufferString_P(entry_ctx.prompt);
+    LCD_bufferMoveCursor(1, 0);
+
+    // Loop to receive the user's input
+    entry_ctx.index = 0;
+    while (entry_ctx.index < entry_ctx.count) {
+        PT_WAIT_UNTIL(pt, takeKey());
 
         // Check if the key pressed is a valid numeric key (0-9)
-        if (key >= 0 && key <= 9) {
-            LCD_displayCharacter('*'); // Display an asterisk to mask the input
-            Password_2[i] = key; // Store the entered digit in the confirmation password array
-            _delay_ms(KEY_DELAY); // Delay for stability
+        if (ui_ctx.key <= 9) {
+            if (entry_ctx.masked) {
+                LCD_bufferCharacter('*'); // Display an asterisk to mask the input
+            } else {
+                LCD_bufferIntgerToString(ui_ctx.key);
+            }
+            entry_ctx.digits[entry_ctx.index] = ui_ctx.key; // Store the entered digit
+            if (entry_ctx.streamed) {
+                sendDigit();
+            }
+            entry_ctx.index++;
         }
     }
 
     // Wait for the user to press the "Enter" button on the keypad
-    while (KEYPAD_getPressedKey() != ENTER_BUTTON);
+    do {
+        PT_WAIT_UNTIL(pt, takeKey());
+    } while (ui_ctx.key != ENTER_BUTTON);
 
-    // Send the confirmation part of the new password via UART
-    for (i = 0; i < PASS_LENGTH; i++) {
-        UART_sendByte(Password_2[i]);
-        _delay_ms(UART_DELAY);
-    }
+    PT_END(pt);
+}
 
-    // Clear the LCD and receive a flag via UART to indicate if the passwords match
-    LCD_clearScreen();
-    flag = UART_recieveByte();
+/*
+ * Description:
+ * Helper Function responsible for checking for the reply frame of the CONTROL ECU.
+ * Return TRUE when it is received.
+ */
+boolean receiveStatus(void) {
+    return (PROTOCOL_poll(&ui_ctx.frame) && ui_ctx.frame.type == PROTOCOL_MSG_REPLY) ? TRUE : FALSE;
+}
 
-    // Check the flag to determine if the passwords match
-    if (flag == 1) {
-        LCD_displayString("Matching....");
-        _delay_ms(NORMAL_DELAY);
-    } else {
-        LCD_displayString("Not Matching!");
-        _delay_ms(NORMAL_DELAY);
-        createNewPass(); // Retry password creation in case of non-matching passwords
+/*
+ * Description:
+ * Helper Function responsible for checking for the reply frame of the CONTROL ECU.
+ * Return TRUE when it is received, its status is stored in flag.
+ */
+boolean takeStatus(void) {
+    if (receiveStatus()) {
+        ui_ctx.flag = ui_ctx.frame.payload[0];
+        return TRUE;
     }
+    return FALSE;
 }
 
+/*
+ * Description:
+ * Thread responsible for asking the CONTROL ECU at startup if a password is set,
+ * the request is repeated until it replies as it may start after the HMI.
+ * It ends with MATCH to show the options or MISMATCH to create the password.
+ */
+PT_THREAD(connect(PT_Thread *pt)) {
+    PT_BEGIN(pt);
+
+    ui_ctx.flag = UI_NO_STATUS;
+    do {
+        PROTOCOL_sendFrame(PROTOCOL_MSG_GET_STATE, NULL_PTR, 0);
+        SysTick_startTimer(&ui_ctx.timer, CONNECT_RETRY_TIME, 0, NULL_PTR);
+        PT_WAIT_UNTIL(pt, takeStatus() || !SysTick_isTimerActive(&ui_ctx.timer));
+    } while (ui_ctx.flag == UI_NO_STATUS);
 
+    SysTick_stopTimer(&ui_ctx.timer);
+    ui_ctx.event = ui_ctx.flag;
+
+    PT_END(pt);
+}
 
 /*
  * Description:
- * Helper Function responsible for receiving and sending a password via UART and the keypad.
- * It allows the user to enter a password, masking the input with asterisks.
+ * Thread responsible for creating new passwords based on user input and confirming the new password.
+ * It ends with the status of the CONTROL ECU.
  */
-void checkPass(void) {
-    LCD_clearScreen();
-    uint8 Password[PASS_LENGTH];
-    LCD_displayString("Plz Enter Pass:");
-    LCD_moveCursor(1, 0);
+PT_THREAD(createNewPass(PT_Thread *pt)) {
+    uint8 i;
 
-    i = key = 0;
+    PT_BEGIN(pt);
 
-    // Loop to receive the user's input as the entered password
-    while (i < PASS_LENGTH) {
-        key = KEYPAD_getPressedKey();
+    PT_ENTER_DIGITS(pt, MSG_ENTER_PASS, new_pass_ctx.Password_1, PASS_LENGTH, TRUE);
 
-        // Check if the key pressed is a valid numeric key (0-9)
-        if (key >= 0 && key <= 9) {
-            LCD_displayCharacter('*'); // Display an asterisk to mask the input
-            Password[i] = key; // Store the entered digit in the password array
-            _delay_ms(KEY_DELAY); // Delay for stability
-            i++;
-        }
+    // Prompt the user to re-enter the password
+    PT_ENTER_DIGITS(pt, MSG_REENTER_PASS, new_pass_ctx.Password_2, PASS_LENGTH, TRUE);
+
+    // Send the new password and its confirmation in one frame
+    for (i = 0; i < PASS_LENGTH; i++) {
+        request_ctx.payload[i] = new_pass_ctx.Password_1[i];
+        request_ctx.payload[PASS_LENGTH + i] = new_pass_ctx.Password_2[i];
     }
+    PROTOCOL_sendFrame(PROTOCOL_MSG_NEW_PASS, request_ctx.payload, 2 * PASS_LENGTH);
 
-    // Wait for the user to press the "Enter" button on the keypad
-    while (KEYPAD_getPressedKey() != ENTER_BUTTON);
+    // Clear the LCD and receive a status via UART to indicate if the passwords match
+    LCD_bufferClear();
+    PT_RECEIVE_STATUS(pt);
 
-    // Send the entered password via UART
-    for (i = 0; i < PASS_LENGTH; i++) {
-        UART_sendByte(Password[i]);
-        _delay_ms(UART_DELAY);
+    // Check the status to determine if the passwords match
+    if (ui_ctx.flag == PROTOCOL_STATUS_MATCH) {
+        LCD_bufferString_P(MSG_MATCHING);
+    } else {
+        LCD_bufferString_P(MSG_NOT_MATCHING);
     }
+    PT_WAIT_MS(pt, NORMAL_DELAY);
+    ui_ctx.event = ui_ctx.flag;
+
+    PT_END(pt);
 }
 
 /*
  * Description:
- * Function responsible for managing the process of changing the password.
- * It checks the entered password, handles errors, and initiates the creation of a new password.
+ * Thread responsible for displaying options to the user and handling their choice.
+ * It ends with the option key, or UI_DONE after an invalid key.
  */
-void changePass(void) {
-    checkPass(); // Check the entered password and send it via UART
-    flag = UART_recieveByte(); // Receive a flag via UART
-
-    LCD_clearScreen();
-
-    // Check the flag to determine the next actions
-    if (flag == 1) {
-        LCD_displayString("Correct pass");
-        _delay_ms(NORMAL_DELAY);
-        createNewPass(); // Proceed to create a new password
-    } else if ((flag == 0 )&&( errorTrial < MAX_ERROR_TRIALS)) {
-        errorTrial++;
-        LCD_displayString("Not Correct!");
-        _delay_ms(NORMAL_DELAY);
-        changePass(); // Retry the password change with limited error trials
-    } else if((errorTrial>= MAX_ERROR_TRIALS)&&(flag==0)) {
-        turnOnBuzzer(); // Sound the buzzer in case of too many errors
-        errorTrial = 0; // Reset the error trial count
+PT_THREAD(showOptions(PT_Thread *pt)) {
+    PT_BEGIN(pt);
+
+    LCD_bufferClear();
+    LCD_bufferMoveCursor(0, 0);
+    LCD_bufferString_P(MSG_OPTIONS_ROW_0);
+    LCD_bufferMoveCursor(1, 0);
+    LCD_bufferString_P(MSG_OPTIONS_ROW_1);
+    PT_WAIT_UNTIL(pt, takeKey());
+
+    // Check if the user's choice is valid (+, -, * or %)
+    if (ui_ctx.key == UI_KEY_OPEN || ui_ctx.key == UI_KEY_CHANGE ||
+            ui_ctx.key == UI_KEY_ENROLL || ui_ctx.key == UI_KEY_REVOKE) {
+        ui_ctx.event = ui_ctx.key;
+    } else {
+        LCD_bufferClear();
+        LCD_bufferString_P(MSG_INVALID_KEY);
+        PT_WAIT_MS(pt, NORMAL_DELAY);
+        ui_ctx.event = UI_DONE;
     }
+
+    PT_END(pt);
 }
 
 /*
  * Description:
- * Function responsible for displaying options to the user and handling their choice.
- * 1 - Open the door.
- * 2 - Change the password.
+ * Thread responsible for managing the process of changing the password.
+ * It checks the entered password and ends with the status of the CONTROL ECU.
  */
-void showOptions(void) {
-    LCD_clearScreen();
-    LCD_moveCursor(0, 0);
-    LCD_displayString("+ : Open Door");
-    LCD_moveCursor(1, 0);
-    LCD_displayString("- : Change Pass");
-    key = KEYPAD_getPressedKey();
-
-    // Check if the user's choice is valid (+ or -)
-    if (key == '-') {
-        UART_sendByte(key); // Send the user's choice via UART
-        changePass(); // Initiate the password change process
-        }
-    else if (key == '+') {
-    	UART_sendByte(key); // Send the user's choice via UART
-        openDoor(); // Initiate the process to open the door
-        }
-    else {
-        LCD_clearScreen();
-        LCD_displayString("Enter Valid Key");
-        _delay_ms(NORMAL_DELAY);
-        showOptions(); // Retry the option selection if an invalid key is pressed
+PT_THREAD(changePass(PT_Thread *pt)) {
+    PT_BEGIN(pt);
+
+    // Check the entered password and send it via UART
+    PT_ENTER_REQUEST_PASS(pt);
+    PROTOCOL_sendFrame(PROTOCOL_MSG_CHANGE_PASS, request_ctx.payload, PASS_REQUEST_LENGTH);
+    PT_RECEIVE_STATUS(pt);
+
+    LCD_bufferClear();
+
+    // Check the status to determine the next actions
+    if (ui_ctx.flag == PROTOCOL_STATUS_MATCH) {
+        LCD_bufferString_P(MSG_CORRECT_PASS);
+        PT_WAIT_MS(pt, NORMAL_DELAY);
+    } else if (ui_ctx.flag == PROTOCOL_STATUS_MISMATCH) {
+        LCD_bufferString_P(MSG_WRONG_PASS);
+        PT_WAIT_MS(pt, NORMAL_DELAY);
     }
-}
+    ui_ctx.event = ui_ctx.flag;
 
+    PT_END(pt);
+}
 
 /*
  * Description:
- * Function responsible for managing the opening of the door.
- * It checks the entered password, processes the result, and controls the door.
+ * Thread responsible for managing the opening of the door.
+ * It checks the entered password and ends with the status of the CONTROL ECU.
  */
-void openDoor(void) {
-    checkPass(); // Check the entered password
-    flag = UART_recieveByte(); // Receive a flag via UART
-
-    LCD_clearScreen();
-
-    // Check the flag to determine the next actions
-    if (flag == 1 && errorTrial == 0) {
-        turnOnMotor(); // Open the door if the entered password is correct
-    } else if (flag == 0 && errorTrial < MAX_ERROR_TRIALS) {
-        errorTrial++;
-        LCD_displayString("Not Correct!");
-        _delay_ms(NORMAL_DELAY);
-        openDoor(); // Retry the door opening with limited error trials
-    } else if(errorTrial >= MAX_ERROR_TRIALS){
-        turnOnBuzzer(); // Sound the buzzer in case of too many errors
-        errorTrial = 0; // Reset the error trial count
+PT_THREAD(openDoor(PT_Thread *pt)) {
+    PT_BEGIN(pt);
+
+    // Check the entered password and send it via UART
+    PT_ENTER_REQUEST_PASS(pt);
+    PROTOCOL_sendFrame(PROTOCOL_MSG_OPEN_DOOR, request_ctx.payload, PASS_REQUEST_LENGTH);
+    PT_RECEIVE_STATUS(pt);
+
+    LCD_bufferClear();
+
+    // Check the status to determine the next actions
+    if (ui_ctx.flag == PROTOCOL_STATUS_MISMATCH) {
+        LCD_bufferString_P(MSG_WRONG_PASS);
+        PT_WAIT_MS(pt, NORMAL_DELAY);
     }
+    ui_ctx.event = ui_ctx.flag;
+
+    PT_END(pt);
 }
 
 /*
  * Description:
- * Function responsible for turning on the buzzer in case of errors.
+ * Thread responsible for turning on the buzzer in case of errors.
  * It waits for a specified duration to indicate an error state.
  */
-void turnOnBuzzer(void) {
-    TIMER1_g_ticks = 0; // Reset the timer ticks to 0
-    LCD_clearScreen();
-    LCD_displayString("Error !!!");
+PT_THREAD(turnOnBuzzer(PT_Thread *pt)) {
+    PT_BEGIN(pt);
+
+    LCD_bufferClear();
+    LCD_bufferString_P(MSG_ERROR);
 
     // Wait for a specified duration (DangerTime) while indicating an error state
-    while (TIMER1_g_ticks < DANGER_TIME);
-}
+    PT_WAIT_MS(pt, DANGER_TIME);
+    ui_ctx.event = UI_DONE;
 
-/*
- * Description:
- * Callback function for timer 1.
- * It increments the timer ticks for timekeeping purposes.
- */
-void Callback(void) {
-    TIMER1_g_ticks++; // Increment the timer ticks
+    PT_END(pt);
 }
 
 /*
  * Description:
- * Function responsible for managing the state of the door.
- * It controls the door's actions, including unlocking, holding, and locking.
+ * Thread responsible for managing the state of the door.
+ * It shows the door's actions, including unlocking, holding, and locking.
  */
-void turnOnMotor(void) {
-    TIMER1_g_ticks = 0; // Reset the timer ticks to 0
-    LCD_clearScreen();
+PT_THREAD(turnOnMotor(PT_Thread *pt)) {
+    PT_BEGIN(pt);
 
-    LCD_displayString("Door Un-locking");
+    LCD_bufferClear();
+    LCD_bufferString_P(MSG_DOOR_UNLOCKING);
 
     // Wait for a specified duration (OpenTime) while unlocking the door
-    while (TIMER1_g_ticks < OPEN_TIME);
+    PT_WAIT_MS(pt, OPEN_TIME);
 
-    LCD_clearScreen();
-    LCD_displayString("Holding");
+    LCD_bufferClear();
+    LCD_bufferString_P(MSG_DOOR_HOLDING);
 
     // Wait for a specified duration (HoldingTime) while holding the door open
-    while (TIMER1_g_ticks < OPEN_TIME + HOLDING_TIME);
+    PT_WAIT_MS(pt, HOLDING_TIME);
 
-    LCD_clearScreen();
-    LCD_displayString("Door Locking");
+    LCD_bufferClear();
+    LCD_bufferString_P(MSG_DOOR_LOCKING);
 
     // Wait for a specified duration (CloseTime) while locking the door
-    while (TIMER1_g_ticks < OPEN_TIME + HOLDING_TIME+ CLOSE_TIME);
+    PT_WAIT_MS(pt, CLOSE_TIME);
+    ui_ctx.event = UI_DONE;
+
+    PT_END(pt);
 }
 
+/*
+ * Description:
+ * Helper Function responsible for converting the entered user ID digits and storing it in the payload.
+ */
+void storeUserId(void) {
+    uint8 i;
+    uint8 id = 0;
+
+    for (i = 0; i < USER_ID_DIGITS; i++) {
+        id = id * 10 + request_ctx.id_digits[i];
+    }
+    request_ctx.payload[PROTOCOL_USER_ID_INDEX] = id;
+}
 
+/*
+ * Description:
+ * Thread responsible for adding a user.
+ * It takes the master password, the user ID and the user code then sends them in one frame.
+ */
+PT_THREAD(enrollUser(PT_Thread *pt)) {
+    PT_BEGIN(pt);
+
+    PT_ENTER_DIGITS(pt, MSG_ENTER_PASS, request_ctx.payload, PASS_LENGTH, TRUE);
+    PT_ENTER_DIGITS(pt, MSG_USER_ID, request_ctx.id_digits, USER_ID_DIGITS, FALSE);
+    storeUserId();
+    PT_ENTER_DIGITS(pt, MSG_USER_CODE, &request_ctx.payload[PROTOCOL_USER_CODE_INDEX], PASS_LENGTH, TRUE);
+    PROTOCOL_sendFrame(PROTOCOL_MSG_ENROLL, request_ctx.payload, PROTOCOL_USER_CODE_INDEX + PASS_LENGTH);
+    PT_RECEIVE_STATUS(pt);
+
+    LCD_bufferClear();
+
+    // Check the status to determine the next actions
+    if (ui_ctx.flag == PROTOCOL_STATUS_MATCH) {
+        LCD_bufferString_P(MSG_USER_ADDED);
+        PT_WAIT_MS(pt, NORMAL_DELAY);
+    } else if (ui_ctx.flag == PROTOCOL_STATUS_REFUSED) {
+        LCD_bufferString_P(MSG_USER_NOT_ADDED);
+        PT_WAIT_MS(pt, NORMAL_DELAY);
+    } else if (ui_ctx.flag == PROTOCOL_STATUS_MISMATCH) {
+        LCD_bufferString_P(MSG_WRONG_PASS);
+        PT_WAIT_MS(pt, NORMAL_DELAY);
+    }
+    ui_ctx.event = ui_ctx.flag;
+
+    PT_END(pt);
+}
+
+/*
+ * Description:
+ * Thread responsible for removing a user.
+ * It takes the master password and the user ID then sends them in one frame.
+ */
+PT_THREAD(revokeUser(PT_Thread *pt)) {
+    PT_BEGIN(pt);
+
+    PT_ENTER_DIGITS(pt, MSG_ENTER_PASS, request_ctx.payload, PASS_LENGTH, TRUE);
+    PT_ENTER_DIGITS(pt, MSG_USER_ID, request_ctx.id_digits, USER_ID_DIGITS, FALSE);
+    storeUserId();
+    PROTOCOL_sendFrame(PROTOCOL_MSG_REVOKE, request_ctx.payload, PROTOCOL_USER_ID_INDEX + 1);
+    PT_RECEIVE_STATUS(pt);
+
+    LCD_bufferClear();
+
+    // Check the status to determine the next actions
+    if (ui_ctx.flag == PROTOCOL_STATUS_MATCH) {
+        LCD_bufferString_P(MSG_USER_REMOVED);
+        PT_WAIT_MS(pt, NORMAL_DELAY);
+    } else if (ui_ctx.flag == PROTOCOL_STATUS_REFUSED) {
+        LCD_bufferString_P(MSG_UNKNOWN_USER);
+        PT_WAIT_MS(pt, NORMAL_DELAY);
+    } else if (ui_ctx.flag == PROTOCOL_STATUS_MISMATCH) {
+        LCD_bufferString_P(MSG_WRONG_PASS);
+        PT_WAIT_MS(pt, NORMAL_DELAY);
+    }
+    ui_ctx.event = ui_ctx.flag;
+
+    PT_END(pt);
+}
@@ -0,0 +1,42 @@
+ /******************************************************************************
+ *
+ * Module: CRC
+ *
+ * File Name: crc.h
+ *
+ * Description: Header file for the CRC-8 checksum helpers
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#ifndef CRC_H_
+#define CRC_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* CRC-8 polynomial x^8 + x^2 + x + 1 (CRC-8/ATM) and its initial value */
+#define CRC8_POLYNOMIAL                0x07
+#define CRC8_INITIAL_VALUE             0x00
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Add one byte to a running CRC-8 value and return the new value.
+ */
+uint8 CRC8_update(uint8 crc, uint8 data);
+
+/*
+ * Description :
+ * Calculate the CRC-8 of a whole buffer starting from CRC8_INITIAL_VALUE.
+ */
+uint8 CRC8_compute(const uint8 *data, uint8 length);
+
+#endif /* CRC_H_ */
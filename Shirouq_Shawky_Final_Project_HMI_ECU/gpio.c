@@ -318,3 +318,56 @@ uint8 GPIO_readPort(uint8 port_num)
 
 	return value;
 }
+
+/*
+ * Description :
+ * Write the value on the pins of the mask in the required port, the other pins are not changed.
+ * The pins change together in one write with the interrupts masked.
+ * If the input port number is not correct, The function will not handle the request.
+ */
+void GPIO_writeMasked(uint8 port_num, uint8 mask, uint8 value)
+{
+	uint8 sreg;
+
+	/*
+	 * Check if the input number is greater than NUM_OF_PORTS value.
+	 * In this case the input is not valid port number
+	 */
+	if(port_num >= NUM_OF_PORTS)
+	{
+		/* Do Nothing */
+	}
+	else
+	{
+		/* An interrupt changing another pin of the port between the read and the write would be lost */
+		sreg = SREG;
+		cli();
+		GPIO_PORT_REG(port_num) = (GPIO_PORT_REG(port_num) & (uint8)~mask) | (value & mask);
+		SREG = sreg;
+	}
+}
+
+/*
+ * Description :
+ * Read and return the value of the pins of the mask in the required port, the other bits are zero.
+ * If the input port number is not correct, The function will return ZERO value.
+ */
+uint8 GPIO_readMasked(uint8 port_num, uint8 mask)
+{
+	uint8 value = LOGIC_LOW;
+
+	/*
+	 * Check if the input number is greater than NUM_OF_PORTS value.
+	 * In this case the input is not valid port number
+	 */
+	if(port_num >= NUM_OF_PORTS)
+	{
+		/* Do Nothing */
+	}
+	else
+	{
+		value = GPIO_PIN_REG(port_num) & mask;
+	}
+
+	return value;
+}
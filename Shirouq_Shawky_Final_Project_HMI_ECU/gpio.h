@@ -3,6 +3,8 @@
 #define GPIO_H_
 
 #include "std_types.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
 
 /*******************************************************************************
  *                                Definitions                                  *
@@ -24,6 +26,78 @@
 #define PIN6_ID                6
 #define PIN7_ID                7
 
+/*
+ * I/O addresses of the port registers, every port takes 3 addresses
+ * starting from PORTA at 0x1B down to PORTD at 0x12.
+ */
+#define GPIO_PORT_IO_ADDR(port_num)    (0x1B - (3 * (port_num)))
+#define GPIO_DDR_IO_ADDR(port_num)     (0x1A - (3 * (port_num)))
+#define GPIO_PIN_IO_ADDR(port_num)     (0x19 - (3 * (port_num)))
+
+/*
+ * Registers of the required port, the port number should be a constant so the
+ * address is resolved at compile time.
+ */
+#define GPIO_PORT_REG(port_num)        _SFR_IO8(GPIO_PORT_IO_ADDR(port_num))
+#define GPIO_DDR_REG(port_num)         _SFR_IO8(GPIO_DDR_IO_ADDR(port_num))
+#define GPIO_PIN_REG(port_num)         _SFR_IO8(GPIO_PIN_IO_ADDR(port_num))
+
+/*
+ * Pin access in a single SBI/CBI/SBIC instruction even without optimization.
+ * The port number and pin number should be constants, the value can be a variable.
+ * There is no range check, a wrong port or pin is an assembler error.
+ */
+#define GPIO_SET_PIN(port_num, pin_num) \
+	__asm__ __volatile__ ("sbi %0, %1" : : "I" (GPIO_PORT_IO_ADDR(port_num)), "I" (pin_num))
+
+#define GPIO_CLEAR_PIN(port_num, pin_num) \
+	__asm__ __volatile__ ("cbi %0, %1" : : "I" (GPIO_PORT_IO_ADDR(port_num)), "I" (pin_num))
+
+#define GPIO_WRITE_PIN(port_num, pin_num, value) \
+	do { \
+		if((value) == LOGIC_LOW) \
+		{ \
+			GPIO_CLEAR_PIN(port_num, pin_num); \
+		} \
+		else \
+		{ \
+			GPIO_SET_PIN(port_num, pin_num); \
+		} \
+	} while(0)
+
+#define GPIO_SETUP_PIN_OUTPUT(port_num, pin_num) \
+	__asm__ __volatile__ ("sbi %0, %1" : : "I" (GPIO_DDR_IO_ADDR(port_num)), "I" (pin_num))
+
+#define GPIO_SETUP_PIN_INPUT(port_num, pin_num) \
+	__asm__ __volatile__ ("cbi %0, %1" : : "I" (GPIO_DDR_IO_ADDR(port_num)), "I" (pin_num))
+
+/* Read the pin as LOGIC_HIGH or LOGIC_LOW */
+#define GPIO_READ_PIN(port_num, pin_num) \
+	({ \
+		uint8 gpio_value; \
+		__asm__ __volatile__ ("ldi %0, %3\n\t" \
+				"sbic %1, %2\n\t" \
+				"ldi %0, %4" \
+				: "=d" (gpio_value) \
+				: "I" (GPIO_PIN_IO_ADDR(port_num)), "I" (pin_num), "M" (LOGIC_LOW), "M" (LOGIC_HIGH)); \
+		gpio_value; \
+	})
+
+/*
+ * Write the value on the pins of the mask in one read-modify-write with the interrupts
+ * masked, the other pins of the port keep their values. The port number should be a constant.
+ */
+#define GPIO_WRITE_MASKED(port_num, mask, value) \
+	do { \
+		uint8 gpio_sreg = SREG; \
+		cli(); \
+		GPIO_PORT_REG(port_num) = (GPIO_PORT_REG(port_num) & (uint8)~(mask)) | ((value) & (mask)); \
+		SREG = gpio_sreg; \
+	} while(0)
+
+/* Read the pins of the mask in one read, the other bits are zero */
+#define GPIO_READ_MASKED(port_num, mask) (GPIO_PIN_REG(port_num) & (mask))
+
 /*******************************************************************************
  *                               Types Declaration                             *
  *******************************************************************************/
@@ -88,4 +162,19 @@ void GPIO_writePort(uint8 port_num, uint8 value);
  */
 uint8 GPIO_readPort(uint8 port_num);
 
+/*
+ * Description :
+ * Write the value on the pins of the mask in the required port, the other pins are not changed.
+ * The pins change together in one write with the interrupts masked.
+ * If the input port number is not correct, The function will not handle the request.
+ */
+void GPIO_writeMasked(uint8 port_num, uint8 mask, uint8 value);
+
+/*
+ * Description :
+ * Read and return the value of the pins of the mask in the required port, the other bits are zero.
+ * If the input port number is not correct, The function will return ZERO value.
+ */
+uint8 GPIO_readMasked(uint8 port_num, uint8 mask);
+
 #endif /* GPIO_H_ */
@@ -11,141 +11,408 @@
  *******************************************************************************/
 #include "keypad.h"
 #include "gpio.h"
-#include <util/delay.h>
+#include "systick.h"
 #include "common_macros.h"
-
+#include "power.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 
 /*******************************************************************************
- *                      Functions Prototypes(Private)                          *
+ *                                Definitions                                  *
  *******************************************************************************/
 
-#if (KEYPAD_NUM_COLS == 3)
 /*
- * Function responsible for mapping the switch number in the keypad to
- * its corresponding functional number in the proteus for 4x3 keypad
+ * Count one scan for the keys in delta and clear the counters of the other keys,
+ * carry holds the keys counting into this bit and then the keys carrying out of it.
  */
-static uint8 KEYPAD_4x3_adjustKeyNumber(uint8 button_number);
-#elif (KEYPAD_NUM_COLS == 4)
+#define KEYPAD_COUNTER_STEP(count) \
+	do { \
+		uint16 next_carry = (count) & carry; \
+		(count) = ((count) ^ carry) & delta; \
+		carry = next_carry; \
+	} while(0)
+
+#if (KEYPAD_BUTTON_PRESSED == LOGIC_LOW)
+/* Drive the column low and pull up the rows */
+#define KEYPAD_COLUMN_DRIVE(col)    ((uint8)~(1 << (KEYPAD_FIRST_COLUMN_PIN_ID + (col))))
+#define KEYPAD_READ_ROWS()          ((uint8)((uint8)~GPIO_PIN_REG(KEYPAD_PORT_ID) & KEYPAD_ROWS_MASK) >> KEYPAD_FIRST_ROW_PIN_ID)
+#else
+/* Drive the column high and leave the rows floating */
+#define KEYPAD_COLUMN_DRIVE(col)    ((uint8)(1 << (KEYPAD_FIRST_COLUMN_PIN_ID + (col))))
+#define KEYPAD_READ_ROWS()          ((uint8)(GPIO_PIN_REG(KEYPAD_PORT_ID) & KEYPAD_ROWS_MASK) >> KEYPAD_FIRST_ROW_PIN_ID)
+#endif
+
 /*
- * Function responsible for mapping the switch number in the keypad to
- * its corresponding functional number in the proteus for 4x4 keypad
+ * Drive one column, the rest of the port are inputs, and shift its rows into keys.
+ * The columns are scanned from the last one so the first column ends in the low bits.
  */
-static uint8 KEYPAD_4x4_adjustKeyNumber(uint8 button_number);
+#define KEYPAD_SCAN_COLUMN(col) \
+	do { \
+		GPIO_DDR_REG(KEYPAD_PORT_ID) = (uint8)(1 << (KEYPAD_FIRST_COLUMN_PIN_ID + (col))); \
+		GPIO_PORT_REG(KEYPAD_PORT_ID) = KEYPAD_COLUMN_DRIVE(col); \
+		__builtin_avr_delay_cycles(KEYPAD_SETTLE_CYCLES); \
+		keys = (keys << KEYPAD_NUM_ROWS) | KEYPAD_READ_ROWS(); \
+	} while(0)
+
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+static SysTick_Timer g_scanTimer;
+
+/* Debounced state of the keys, bit (col * KEYPAD_NUM_ROWS + row) is set while the key is pressed */
+static uint16 g_keysState = 0;
+
+/*
+ * Vertical counters, bit n of every word is one bit of the counter of key n.
+ * A key counts the scans it has been different from its debounced state.
+ */
+static uint16 g_debounceCount0 = 0;
+#if (KEYPAD_DEBOUNCE_BITS >= 2)
+static uint16 g_debounceCount1 = 0;
+#endif
+#if (KEYPAD_DEBOUNCE_BITS >= 3)
+static uint16 g_debounceCount2 = 0;
+#endif
+
+/* Last pressed key and the scans it has been held since its press */
+static uint8 g_holdKey = 0;
+static uint8 g_holdCount = KEYPAD_LONG_PRESS_SCANS;
+
+/* Value of every key, one line per column */
+#if (KEYPAD_NUM_COLS == 3)
+static const uint8 g_keymap[KEYPAD_NUM_KEYS] PROGMEM =
+{
+	1, 4, 7, '*',
+	2, 5, 8, 0,
+	3, 6, 9, '#'
+};
+#elif (KEYPAD_NUM_COLS == 4)
+static const uint8 g_keymap[KEYPAD_NUM_KEYS] PROGMEM =
+{
+	7, 4, 1, 13,                /* 13 is the ASCII of Enter */
+	8, 5, 2, 0,
+	9, 6, 3, '=',
+	'%', '*', '-', '+'
+};
+#else
+#error "The keypad should have 3 or 4 columns"
 #endif
 
+/* Scans with no key pressed, the scanning stops at KEYPAD_QUIET_SCANS */
+static uint16 g_quietScans = 0;
+
+/* The columns are driven waiting for INT0 */
+static volatile boolean g_waiting = FALSE;
+
+/* The first scan after a wake up should measure the latency */
+static boolean g_wakePending = FALSE;
+
+/* Tick the wait started and the Timer1 count of the wake interrupt */
+static uint32 g_waitTick;
+static uint32 g_wakeCounts;
+
+static KEYPAD_WakeStats g_wakeStats;
+
+/* Events queue, filled by the SysTick interrupt and emptied by the main program */
+static KEYPAD_Event g_events[KEYPAD_EVENT_QUEUE_SIZE];
+static volatile uint8 g_eventsHead = 0;
+static volatile uint8 g_eventsTail = 0;
+
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* Scan all the keys, bit (col * KEYPAD_NUM_ROWS + row) is set if the key is pressed */
+static uint16 KEYPAD_scanMatrix(void);
+
+/* Map the bit of a key in the matrix to its value */
+static uint8 KEYPAD_keyValue(uint8 key_index);
+
+/* Called by SysTick every KEYPAD_SCAN_PERIOD_MS to debounce the keys */
+static void KEYPAD_scanHandler(SysTick_Timer *timer);
+
+/* Add an event to the queue, it is dropped if the queue is full */
+static void KEYPAD_postEvent(uint8 key_index, KEYPAD_EventType type);
+
+/* Drive all the columns so any press pulls its row and the INT0 pin low */
+static void KEYPAD_driveAllColumns(void);
+
+/* Stop the scanning and arm INT0, it runs in the SysTick interrupt */
+static void KEYPAD_startWaiting(void);
+
+/* Start the scanning again, the interrupts should be disabled */
+static void KEYPAD_stopWaiting(void);
+
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
+void KEYPAD_init(void)
+{
+	if(KEYPAD_USE_WAKE_INTERRUPT != 0)
+	{
+		/* INT0 pin as input with its pull up, the interrupt on its falling edge */
+		GPIO_SETUP_PIN_INPUT(KEYPAD_WAKE_PORT_ID, KEYPAD_WAKE_PIN_ID);
+		GPIO_SET_PIN(KEYPAD_WAKE_PORT_ID, KEYPAD_WAKE_PIN_ID);
+		MCUCR = (MCUCR & ~((1<<ISC01) | (1<<ISC00))) | (1<<ISC01);
+	}
+	SysTick_startTimer(&g_scanTimer, KEYPAD_SCAN_PERIOD_MS, KEYPAD_SCAN_PERIOD_MS, KEYPAD_scanHandler);
+}
+
+boolean KEYPAD_getEvent(KEYPAD_Event *event)
+{
+	if(g_eventsTail == g_eventsHead)
+	{
+		return FALSE;
+	}
+	*event = g_events[g_eventsTail];
+	g_eventsTail = (uint8)((g_eventsTail + 1) & (KEYPAD_EVENT_QUEUE_SIZE - 1));
+	return TRUE;
+}
+
+void KEYPAD_clearEvents(void)
+{
+	g_eventsTail = g_eventsHead;
+}
+
 uint8 KEYPAD_getPressedKey(void)
 {
-	uint8 col,row;
-	uint8 keypad_port_value = 0;
-	while(1)
+	KEYPAD_Event event;
+
+	/* Sleep until the scan interrupt adds a press event */
+	do
 	{
-		for(col=0;col<KEYPAD_NUM_COLS;col++) /* loop for columns */
+		POWER_WAIT_WHILE(g_eventsTail == g_eventsHead);
+		KEYPAD_getEvent(&event);
+	} while(event.type != KEYPAD_PRESS);
+
+	return event.key;
+}
+
+uint8 KEYPAD_scanKey(void)
+{
+	uint16 keys;
+	uint8 key_index;
+	uint8 sreg = SREG;
+
+	/* The scan interrupt uses the same port */
+	cli();
+	keys = KEYPAD_scanMatrix();
+	if(g_waiting)
+	{
+		KEYPAD_driveAllColumns();
+	}
+	SREG = sreg;
+
+	for(key_index = 0; key_index < KEYPAD_NUM_KEYS; key_index++)
+	{
+		if(keys & (1 << key_index))
 		{
-			/* 
-			 * Each time setup the direction for all keypad port as input pins,
-			 * except this column will be output pin
-			 */
-			GPIO_setupPortDirection(KEYPAD_PORT_ID,PORT_INPUT);
-			GPIO_setupPinDirection(KEYPAD_PORT_ID,KEYPAD_FIRST_COLUMN_PIN_ID+col,PIN_OUTPUT);
-
-#if(KEYPAD_BUTTON_PRESSED == LOGIC_LOW)
-			/* Clear the column output pin and set the rest pins value */
-			keypad_port_value = ~(1<<(KEYPAD_FIRST_COLUMN_PIN_ID+col));
-#else
-			/* Set the column output pin and clear the rest pins value */
-			keypad_port_value = (1<<(KEYPAD_FIRST_COLUMN_PIN_ID+col));
+			return KEYPAD_keyValue(key_index);
+		}
+	}
+
+	return KEYPAD_NO_KEY;
+}
+
+void KEYPAD_getWakeStats(KEYPAD_WakeStats *stats)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	*stats = g_wakeStats;
+	if(g_waiting)
+	{
+		/* Count the scans saved by the current wait too */
+		stats->saved_scans += (SysTick_getTicks() - g_waitTick) / SYSTICK_MS_TO_TICKS(KEYPAD_SCAN_PERIOD_MS);
+	}
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Scan all the keys, bit (col * KEYPAD_NUM_ROWS + row) is set if the key is pressed.
+ * Every column is driven alone and all its rows are taken from one read of the PIN register.
+ */
+static uint16 KEYPAD_scanMatrix(void)
+{
+	uint16 keys = 0;
+
+#if (KEYPAD_NUM_COLS == 4)
+	KEYPAD_SCAN_COLUMN(3);
 #endif
-			GPIO_writePort(KEYPAD_PORT_ID,keypad_port_value);
+	KEYPAD_SCAN_COLUMN(2);
+	KEYPAD_SCAN_COLUMN(1);
+	KEYPAD_SCAN_COLUMN(0);
+
+	return keys;
+}
 
-			for(row=0;row<KEYPAD_NUM_ROWS;row++) /* loop for rows */
+/*
+ * Description :
+ * Map the bit of a key in the matrix to its value.
+ */
+static uint8 KEYPAD_keyValue(uint8 key_index)
+{
+	return pgm_read_byte(&g_keymap[key_index]);
+}
+
+/*
+ * Description :
+ * Debounce all the keys together, it runs in the SysTick interrupt.
+ * Every key has a counter of KEYPAD_DEBOUNCE_BITS bits held in the vertical counters,
+ * it counts the scans the key is different from its debounced state and is cleared
+ * once they are equal. The key changes its state when its counter overflows, then a
+ * press or release event is added.
+ * The last pressed key gives a long press event once it is held for KEYPAD_LONG_PRESS_SCANS scans.
+ */
+static void KEYPAD_scanHandler(SysTick_Timer *timer)
+{
+	uint16 keys = KEYPAD_scanMatrix();
+	uint16 delta = keys ^ g_keysState;
+	uint16 carry = delta;
+	uint8 key_index;
+
+	if(g_wakePending)
+	{
+		g_wakePending = FALSE;
+		g_wakeStats.last_latency = SysTick_getCounts() - g_wakeCounts;
+		if(g_wakeStats.last_latency > g_wakeStats.max_latency)
+		{
+			g_wakeStats.max_latency = g_wakeStats.last_latency;
+		}
+	}
+
+	KEYPAD_COUNTER_STEP(g_debounceCount0);
+#if (KEYPAD_DEBOUNCE_BITS >= 2)
+	KEYPAD_COUNTER_STEP(g_debounceCount1);
+#endif
+#if (KEYPAD_DEBOUNCE_BITS >= 3)
+	KEYPAD_COUNTER_STEP(g_debounceCount2);
+#endif
+
+	/* The keys carrying out of the last bit change their state */
+	g_keysState ^= carry;
+
+	/* Most of the scans have no change */
+	for(key_index = 0; carry != 0; key_index++, carry >>= 1)
+	{
+		if(carry & 1)
+		{
+			if(g_keysState & (uint16)(1 << key_index))
 			{
-				/* Check if the switch is pressed in this row */
-				if(GPIO_readPin(KEYPAD_PORT_ID,row+KEYPAD_FIRST_ROW_PIN_ID) == KEYPAD_BUTTON_PRESSED)
-				{
-					#if (KEYPAD_NUM_COLS == 3)
-						return KEYPAD_4x3_adjustKeyNumber((row*KEYPAD_NUM_COLS)+col+1);
-					#elif (KEYPAD_NUM_COLS == 4)
-						return KEYPAD_4x4_adjustKeyNumber((row*KEYPAD_NUM_COLS)+col+1);
-					#endif
-				}
+				KEYPAD_postEvent(key_index, KEYPAD_PRESS);
+				g_holdKey = key_index;
+				g_holdCount = 0;
+			}
+			else
+			{
+				KEYPAD_postEvent(key_index, KEYPAD_RELEASE);
 			}
 		}
-	}	
-}
+	}
 
-#if (KEYPAD_NUM_COLS == 3)
+	if((g_holdCount < KEYPAD_LONG_PRESS_SCANS) && (g_keysState & (uint16)(1 << g_holdKey)))
+	{
+		if(++g_holdCount == KEYPAD_LONG_PRESS_SCANS)
+		{
+			KEYPAD_postEvent(g_holdKey, KEYPAD_LONG_PRESS);
+		}
+	}
+	else
+	{
+		/* The long press is not given after the key is released */
+		g_holdCount = KEYPAD_LONG_PRESS_SCANS;
+	}
+
+	if((keys | g_keysState) != 0)
+	{
+		g_quietScans = 0;
+	}
+	else if((KEYPAD_USE_WAKE_INTERRUPT != 0) && (++g_quietScans >= KEYPAD_QUIET_SCANS))
+	{
+		KEYPAD_startWaiting();
+	}
+}
 
 /*
  * Description :
- * Update the keypad pressed button value with the correct one in keypad 4x3 shape
+ * Add an event to the queue, it runs in the SysTick interrupt.
  */
-static uint8 KEYPAD_4x3_adjustKeyNumber(uint8 button_number)
+static void KEYPAD_postEvent(uint8 key_index, KEYPAD_EventType type)
 {
-	uint8 keypad_button = 0;
-	switch(button_number)
+	uint8 next = (uint8)((g_eventsHead + 1) & (KEYPAD_EVENT_QUEUE_SIZE - 1));
+
+	if(next != g_eventsTail)
 	{
-		case 10: keypad_button = '*'; // ASCII Code of *
-				 break;
-		case 11: keypad_button = 0;
-				 break;		
-		case 12: keypad_button = '#'; // ASCII Code of #
-				 break;
-		default: keypad_button = button_number;
-				break;
+		g_events[g_eventsHead].key = KEYPAD_keyValue(key_index);
+		g_events[g_eventsHead].type = type;
+		g_eventsHead = next;
 	}
-	return keypad_button;
-} 
+}
 
-#elif (KEYPAD_NUM_COLS == 4)
+/*
+ * Description :
+ * Drive all the columns at once, the rows are pulled up and a press pulls its row low.
+ */
+static void KEYPAD_driveAllColumns(void)
+{
+	GPIO_DDR_REG(KEYPAD_PORT_ID) = KEYPAD_COLUMNS_MASK;
+	GPIO_PORT_REG(KEYPAD_PORT_ID) = (uint8)~KEYPAD_COLUMNS_MASK;
+}
 
 /*
  * Description :
- * Update the keypad pressed button value with the correct one in keypad 4x4 shape
+ * Stop the scanning and arm INT0 to wake it at the next press, it runs in the SysTick interrupt.
+ * The tick stops too once the other timers are done, so only INT0 wakes the CPU.
+ * A key pressed before INT0 is armed gives no edge so the pin is checked after arming.
  */
-static uint8 KEYPAD_4x4_adjustKeyNumber(uint8 button_number)
+static void KEYPAD_startWaiting(void)
 {
-	uint8 keypad_button = 0;
-	switch(button_number)
+	SysTick_stopTimer(&g_scanTimer);
+	KEYPAD_driveAllColumns();
+	g_waiting = TRUE;
+	g_waitTick = SysTick_getTicks();
+	SysTick_setTickless(TRUE);
+
+	/* Clear an old edge by writing one to its flag */
+	GIFR = (1<<INTF0);
+	SET_BIT(GICR, INT0);
+
+	__builtin_avr_delay_cycles(KEYPAD_SETTLE_CYCLES);
+	if(GPIO_READ_PIN(KEYPAD_WAKE_PORT_ID, KEYPAD_WAKE_PIN_ID) == LOGIC_LOW)
 	{
-		case 1: keypad_button = 7;
-				break;
-		case 2: keypad_button = 8;
-				break;
-		case 3: keypad_button = 9;
-				break;
-		case 4: keypad_button = '%'; // ASCII Code of %
-				break;
-		case 5: keypad_button = 4;
-				break;
-		case 6: keypad_button = 5;
-				break;
-		case 7: keypad_button = 6;
-				break;
-		case 8: keypad_button = '*'; /* ASCII Code of '*' */
-				break;		
-		case 9: keypad_button = 1;
-				break;
-		case 10: keypad_button = 2;
-				break;
-		case 11: keypad_button = 3;
-				break;
-		case 12: keypad_button = '-'; /* ASCII Code of '-' */
-				break;
-		case 13: keypad_button = 13;  /* ASCII of Enter */
-				break;			
-		case 14: keypad_button = 0;
-				break;
-		case 15: keypad_button = '='; /* ASCII Code of '=' */
-				break;
-		case 16: keypad_button = '+'; /* ASCII Code of '+' */
-				break;
-		default: keypad_button = button_number;
-				break;
+		g_wakeCounts = SysTick_getCounts();
+		KEYPAD_stopWaiting();
 	}
-	return keypad_button;
-} 
+}
 
-#endif
+/*
+ * Description :
+ * Disarm INT0 and start the tick and the scanning again, the interrupts should be disabled.
+ */
+static void KEYPAD_stopWaiting(void)
+{
+	CLEAR_BIT(GICR, INT0);
+	SysTick_setTickless(FALSE);
+	g_waiting = FALSE;
+	g_wakePending = TRUE;
+	g_quietScans = 0;
+
+	g_wakeStats.wakeups++;
+	g_wakeStats.saved_scans += (SysTick_getTicks() - g_waitTick) / SYSTICK_MS_TO_TICKS(KEYPAD_SCAN_PERIOD_MS);
+
+	SysTick_startTimer(&g_scanTimer, 0, KEYPAD_SCAN_PERIOD_MS, KEYPAD_scanHandler);
+}
+
+/*
+ * Description :
+ * A press pulled the INT0 pin low while the scanning was stopped.
+ */
+ISR(INT0_vect)
+{
+	g_wakeCounts = SysTick_getCounts();
+	KEYPAD_stopWaiting();
+}
@@ -14,6 +14,7 @@
 #define KEYPAD_H_
 
 #include "std_types.h"
+#include "gpio.h"
 
 /*******************************************************************************
  *                                Definitions                                  *
@@ -33,14 +34,140 @@
 #define KEYPAD_BUTTON_PRESSED            LOGIC_LOW
 #define KEYPAD_BUTTON_RELEASED           LOGIC_HIGH
 
+/* Returned by KEYPAD_scanKey when no button is pressed */
+#define KEYPAD_NO_KEY                    0xFF
+
+#define KEYPAD_NUM_KEYS                  (KEYPAD_NUM_ROWS * KEYPAD_NUM_COLS)
+
+/* Port pins of the rows and the columns */
+#define KEYPAD_ROWS_MASK                 (((1 << KEYPAD_NUM_ROWS) - 1) << KEYPAD_FIRST_ROW_PIN_ID)
+#define KEYPAD_COLUMNS_MASK              (((1 << KEYPAD_NUM_COLS) - 1) << KEYPAD_FIRST_COLUMN_PIN_ID)
+
+/*
+ * CPU cycles between driving a column and reading the rows, the pin synchronizer needs 1 cycle.
+ * Increase it if the rows take longer to rise through the pull ups.
+ */
+#define KEYPAD_SETTLE_CYCLES             2
+
+/* Time between the scans done by the SysTick interrupt */
+#define KEYPAD_SCAN_PERIOD_MS            5
+
+/*
+ * Bits of the vertical debounce counters, 1 to 3.
+ * A key should keep its new state for (1 << bits) scans to be accepted (20ms with 2 bits).
+ */
+#define KEYPAD_DEBOUNCE_BITS             2
+#define KEYPAD_DEBOUNCE_SCANS            (1 << KEYPAD_DEBOUNCE_BITS)
+
+#if ((KEYPAD_DEBOUNCE_BITS < 1) || (KEYPAD_DEBOUNCE_BITS > 3))
+#error "The keypad debounce counters should have 1 to 3 bits"
+#endif
+
+/* Scans the last pressed key should be held to give a long press event (1s) */
+#define KEYPAD_LONG_PRESS_SCANS          200
+
+/*
+ * Stop scanning after the keys are released for KEYPAD_QUIET_PERIOD_MS, all the columns are
+ * driven and the first press wakes the scanning through INT0. The rows should be combined
+ * into the INT0 pin (PD2), which is low while any row is low.
+ * The SysTick tick is stopped too while no other timer is active, INT0 starts it again.
+ * It is off as the current board and simulation leave PD2 unconnected, the keypad
+ * would never wake up. The wake code is always compiled, a board with PD2 wired
+ * builds with -DKEYPAD_USE_WAKE_INTERRUPT=1.
+ */
+#ifndef KEYPAD_USE_WAKE_INTERRUPT
+#define KEYPAD_USE_WAKE_INTERRUPT        0
+#endif
+#define KEYPAD_QUIET_PERIOD_MS           2000
+#define KEYPAD_QUIET_SCANS               (KEYPAD_QUIET_PERIOD_MS / KEYPAD_SCAN_PERIOD_MS)
+
+#define KEYPAD_WAKE_PORT_ID              PORTD_ID
+#define KEYPAD_WAKE_PIN_ID               PIN2_ID
+
+#if ((KEYPAD_USE_WAKE_INTERRUPT != 0) && (KEYPAD_BUTTON_PRESSED != LOGIC_LOW))
+#error "The keypad wake interrupt needs the buttons pressed at LOGIC_LOW"
+#endif
+
+/* Events waiting for the main program, should be a power of 2 */
+#define KEYPAD_EVENT_QUEUE_SIZE          8
+
+#if ((KEYPAD_EVENT_QUEUE_SIZE & (KEYPAD_EVENT_QUEUE_SIZE - 1)) != 0)
+#error "The keypad event queue size should be a power of 2"
+#endif
+
+#if (KEYPAD_NUM_KEYS > 16)
+#error "The keypad matrix is scanned in a 16-bit word"
+#endif
+
+#if (((KEYPAD_ROWS_MASK | KEYPAD_COLUMNS_MASK) > 0xFF) || ((KEYPAD_ROWS_MASK & KEYPAD_COLUMNS_MASK) != 0))
+#error "The keypad rows and columns should be different pins of the same port"
+#endif
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+typedef enum
+{
+	KEYPAD_PRESS, KEYPAD_RELEASE, KEYPAD_LONG_PRESS
+}KEYPAD_EventType;
+
+typedef struct
+{
+	uint8 key;                  /* Value of the button, the same as KEYPAD_scanKey */
+	KEYPAD_EventType type;
+}KEYPAD_Event;
+
+/* Statistics of the wake interrupt mode */
+typedef struct
+{
+	uint32 wakeups;             /* Presses that started the scanning again */
+	uint32 saved_scans;         /* Scans not done while waiting for a press, the time with the tick stopped is not counted */
+	uint32 last_latency;        /* From the interrupt to the first scan, in SysTick counts (SYSTICK_COUNT_US) */
+	uint32 max_latency;
+}KEYPAD_WakeStats;
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
 /*
  * Description :
- * Get the Keypad pressed button
+ * Start scanning the keypad every KEYPAD_SCAN_PERIOD_MS, SysTick should be initialized.
+ * The scanning stops after the quiet period if the wake interrupt is used.
+ */
+void KEYPAD_init(void);
+
+/*
+ * Description :
+ * Take the oldest keypad event without waiting.
+ * Return FALSE if there is no event.
+ */
+boolean KEYPAD_getEvent(KEYPAD_Event *event);
+
+/*
+ * Description :
+ * Drop the events that are not taken yet.
+ */
+void KEYPAD_clearEvents(void);
+
+/*
+ * Description :
+ * Wait for the next press event and return its button, the CPU sleeps meanwhile.
  */
 uint8 KEYPAD_getPressedKey(void);
 
+/*
+ * Description :
+ * Scan the keypad once without waiting.
+ * Return the pressed button or KEYPAD_NO_KEY.
+ */
+uint8 KEYPAD_scanKey(void);
+
+/*
+ * Description :
+ * Copy the statistics of the wake interrupt mode.
+ */
+void KEYPAD_getWakeStats(KEYPAD_WakeStats *stats);
+
 #endif /* KEYPAD_H_ */
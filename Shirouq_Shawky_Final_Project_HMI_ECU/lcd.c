@@ -1,9 +1,88 @@
 
-
-#include <util/delay.h> /* For the delay functions */
-#include "common_macros.h" /* For GET_BIT Macro */
 #include "lcd.h"
 #include "gpio.h"
+#include "systick.h"
+#include "common_macros.h" /* For BIT_IS_SET Macro */
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stdlib.h> /* For itoa */
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#if (LCD_USE_BUSY_FLAG == 1)
+/*
+ * Polls of the busy flag covering the long execution time, each poll has at least
+ * LCD_BUSY_POLL_US of delays. A stuck or missing LCD can't hang the SysTick interrupt.
+ */
+#if(LCD_DATA_BITS_MODE == 4)
+#define LCD_BUSY_POLL_US               (4 * LCD_ENABLE_PULSE_US)
+#elif(LCD_DATA_BITS_MODE == 8)
+#define LCD_BUSY_POLL_US               (2 * LCD_ENABLE_PULSE_US)
+#endif
+#define LCD_BUSY_FLAG_MAX_POLLS        ((LCD_LONG_EXECUTION_TIME_US / LCD_BUSY_POLL_US) + 1)
+#endif
+
+/* Ticks skipped after clear or return home so the LCD has its long execution time */
+#define LCD_LONG_EXECUTION_TICKS \
+	((LCD_LONG_EXECUTION_TIME_US + (SYSTICK_TICK_MS * 1000UL) - 1) / (SYSTICK_TICK_MS * 1000UL) - 1)
+
+/* Queue entries needed for one cell, a cursor move and the character */
+#define LCD_CELL_ENTRIES               2
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+#if (LCD_USE_BUSY_FLAG == 1)
+/* The busy flag can be read only after the interface length is set by LCD_init */
+static boolean g_busyFlagValid = FALSE;
+#endif
+
+/* Frame buffer written by the callers and a copy of what the screen shows */
+static uint8 g_frame[LCD_ROWS][LCD_COLS];
+static uint8 g_screen[LCD_ROWS][LCD_COLS];
+
+/* Cursor of the frame buffer */
+static uint8 g_bufferRow = 0;
+static uint8 g_bufferCol = 0;
+
+/* Set when a cell of the frame buffer changes, cleared by LCD_flush */
+static boolean g_frameChanged = FALSE;
+
+/* Background queue, filled by the main program and drained by the SysTick interrupt */
+static uint8 g_queue[LCD_QUEUE_SIZE];
+static uint8 g_queueCommands[LCD_QUEUE_SIZE / 8];   /* Bit for every entry that is a command */
+static volatile uint8 g_queueHead = 0;
+static volatile uint8 g_queueTail = 0;
+static uint8 g_skipTicks = 0;
+static uint32 g_drainStart = 0;
+static SysTick_Timer g_drainTimer;
+static LCD_QueueStats g_queueStats;
+
+/*******************************************************************************
+ *                      Functions Prototypes(Private)                          *
+ *******************************************************************************/
+
+/* Write a command (rs = LOGIC_LOW) or a character (rs = LOGIC_HIGH) to the LCD */
+static void LCD_write(uint8 rs, uint8 value);
+
+/* Wait for the last instruction to complete, unless the busy flag is polled before the next one */
+static void LCD_waitExecution(boolean long_instruction);
+
+/* Address of a specified row and column index in the LCD DDRAM */
+static uint8 LCD_cellAddress(uint8 row,uint8 col);
+
+/* Add an entry to the background queue, return FALSE if it is full */
+static boolean LCD_queue(uint8 value, boolean command);
+
+/* Called by SysTick on every tick while the queue has entries to send the next ones */
+static void LCD_drainQueue(SysTick_Timer *timer);
+
+#if (LCD_USE_BUSY_FLAG == 1)
+/* Poll the busy flag until the LCD can take the next instruction */
+static void LCD_waitBusyFlag(void);
+#endif
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -17,18 +96,26 @@
  */
 void LCD_init(void)
 {
+	uint8 row,col;
+
 	/* Configure the direction for RS and E pins as output pins */
-	GPIO_setupPinDirection(LCD_RS_PORT_ID,LCD_RS_PIN_ID,PIN_OUTPUT);
-	GPIO_setupPinDirection(LCD_E_PORT_ID,LCD_E_PIN_ID,PIN_OUTPUT);
+	GPIO_SETUP_PIN_OUTPUT(LCD_RS_PORT_ID,LCD_RS_PIN_ID);
+	GPIO_SETUP_PIN_OUTPUT(LCD_E_PORT_ID,LCD_E_PIN_ID);
+
+#if (LCD_USE_BUSY_FLAG == 1)
+	/* R/W is high only while the busy flag is read */
+	GPIO_SETUP_PIN_OUTPUT(LCD_RW_PORT_ID,LCD_RW_PIN_ID);
+	GPIO_CLEAR_PIN(LCD_RW_PORT_ID,LCD_RW_PIN_ID);
+#endif
 
-	_delay_ms(20);		/* LCD Power ON delay always > 15ms */
+	LCD_DELAY_US(LCD_POWER_ON_TIME_US);		/* LCD Power ON delay always > 15ms */
 
 #if(LCD_DATA_BITS_MODE == 4)
 	/* Configure 4 pins in the data port as output pins */
-	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID,PIN_OUTPUT);
-	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID,PIN_OUTPUT);
-	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID,PIN_OUTPUT);
-	GPIO_setupPinDirection(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID,PIN_OUTPUT);
+	GPIO_SETUP_PIN_OUTPUT(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID);
+	GPIO_SETUP_PIN_OUTPUT(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID);
+	GPIO_SETUP_PIN_OUTPUT(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID);
+	GPIO_SETUP_PIN_OUTPUT(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID);
 
 	/* Send for 4 bit initialization of LCD  */
 	LCD_sendCommand(LCD_TWO_LINES_FOUR_BITS_MODE_INIT1);
@@ -39,15 +126,32 @@ void LCD_init(void)
 
 #elif(LCD_DATA_BITS_MODE == 8)
 	/* Configure the data port as output port */
-	GPIO_setupPortDirection(LCD_DATA_PORT_ID,PORT_OUTPUT);
+	GPIO_DDR_REG(LCD_DATA_PORT_ID) = PORT_OUTPUT;
 
 	/* use 2-lines LCD + 8-bits Data Mode + 5*7 dot display Mode */
 	LCD_sendCommand(LCD_TWO_LINES_EIGHT_BITS_MODE);
 
 #endif
 
+#if (LCD_USE_BUSY_FLAG == 1)
+	g_busyFlagValid = TRUE;
+#endif
+
 	LCD_sendCommand(LCD_CURSOR_OFF); /* cursor off */
 	LCD_sendCommand(LCD_CLEAR_COMMAND); /* clear LCD at the beginning */
+
+	/* The screen and the frame buffer are both empty */
+	LCD_bufferClear();
+	for(row = 0; row < LCD_ROWS; row++)
+	{
+		for(col = 0; col < LCD_COLS; col++)
+		{
+			g_screen[row][col] = ' ';
+		}
+	}
+	g_frameChanged = FALSE;
+
+	/* From now on the LCD is written by the SysTick interrupt only, the drain timer runs while the queue has entries */
 }
 
 /*
@@ -56,79 +160,133 @@ void LCD_init(void)
  */
 void LCD_sendCommand(uint8 command)
 {
-	GPIO_writePin(LCD_RS_PORT_ID,LCD_RS_PIN_ID,LOGIC_LOW); /* Instruction Mode RS=0 */
-	_delay_ms(1); /* delay for processing Tas = 50ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_HIGH); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
+	LCD_write(LOGIC_LOW,command); /* Instruction Mode RS=0 */
+
+	/* Clear and return home take much longer than the other instructions */
+	LCD_waitExecution((command == LCD_CLEAR_COMMAND) || (command == LCD_GO_TO_HOME));
+}
+
+/*
+ * Description :
+ * Display the required character on the screen
+ */
+void LCD_displayCharacter(uint8 data)
+{
+	LCD_write(LOGIC_HIGH,data); /* Data Mode RS=1 */
+	LCD_waitExecution(FALSE);
+}
+
+/*
+ * Description :
+ * Write a command (rs = LOGIC_LOW) or a character (rs = LOGIC_HIGH) to the LCD.
+ * The data is latched on the falling edge of E.
+ */
+static void LCD_write(uint8 rs, uint8 value)
+{
+#if (LCD_USE_BUSY_FLAG == 1)
+	if(g_busyFlagValid)
+	{
+		LCD_waitBusyFlag();
+	}
+#endif
+
+	GPIO_WRITE_PIN(LCD_RS_PORT_ID,LCD_RS_PIN_ID,rs); /* Tas = 40ns is less than one instruction */
+	GPIO_SET_PIN(LCD_E_PORT_ID,LCD_E_PIN_ID); /* Enable LCD E=1 */
 
 #if(LCD_DATA_BITS_MODE == 4)
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID,GET_BIT(command,4));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID,GET_BIT(command,5));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID,GET_BIT(command,6));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID,GET_BIT(command,7));
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_HIGH); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID,GET_BIT(command,0));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID,GET_BIT(command,1));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID,GET_BIT(command,2));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID,GET_BIT(command,3));
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
+	GPIO_WRITE_MASKED(LCD_DATA_PORT_ID,LCD_DATA_NIBBLE_MASK,(value >> 4) << LCD_DB4_PIN_ID); /* out the high nibble to DB4 --> DB7 */
+	LCD_DELAY_US(LCD_ENABLE_PULSE_US); /* delay for processing Tpw = 230ns */
+	GPIO_CLEAR_PIN(LCD_E_PORT_ID,LCD_E_PIN_ID); /* Disable LCD E=0 */
+	LCD_DELAY_US(LCD_ENABLE_PULSE_US); /* delay for processing Tcycle - Tpw = 270ns */
+	GPIO_SET_PIN(LCD_E_PORT_ID,LCD_E_PIN_ID); /* Enable LCD E=1 */
 
+	GPIO_WRITE_MASKED(LCD_DATA_PORT_ID,LCD_DATA_NIBBLE_MASK,(value & 0x0F) << LCD_DB4_PIN_ID); /* out the low nibble to DB4 --> DB7 */
 #elif(LCD_DATA_BITS_MODE == 8)
-	GPIO_writePort(LCD_DATA_PORT_ID,command); /* out the required command to the data bus D0 --> D7 */
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
+	GPIO_PORT_REG(LCD_DATA_PORT_ID) = value; /* out the required value to the data bus D0 --> D7 */
 #endif
+
+	LCD_DELAY_US(LCD_ENABLE_PULSE_US); /* delay for processing Tpw = 230ns */
+	GPIO_CLEAR_PIN(LCD_E_PORT_ID,LCD_E_PIN_ID); /* Disable LCD E=0, Th = 10ns is less than one instruction */
 }
 
 /*
  * Description :
- * Display the required character on the screen
+ * Wait for the last instruction to complete, the times are the worst case of the datasheet.
+ * When the busy flag is used the wait is done by polling it before the next instruction.
  */
-void LCD_displayCharacter(uint8 data)
+static void LCD_waitExecution(boolean long_instruction)
 {
-	GPIO_writePin(LCD_RS_PORT_ID,LCD_RS_PIN_ID,LOGIC_HIGH); /* Data Mode RS=1 */
-	_delay_ms(1); /* delay for processing Tas = 50ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_HIGH); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
+#if (LCD_USE_BUSY_FLAG == 1)
+	if(g_busyFlagValid)
+	{
+		return;
+	}
+#endif
+
+	if(long_instruction)
+	{
+		LCD_DELAY_US(LCD_LONG_EXECUTION_TIME_US);
+	}
+	else
+	{
+		LCD_DELAY_US(LCD_EXECUTION_TIME_US);
+	}
+}
+
+#if (LCD_USE_BUSY_FLAG == 1)
+/*
+ * Description :
+ * Read the busy flag on DB7 until it is cleared, at most LCD_BUSY_FLAG_MAX_POLLS times.
+ * If it stays set the LCD does not answer, the busy flag is not used anymore and every
+ * instruction waits its worst case execution time.
+ * The data pins are inputs while R/W is high so the LCD and the MCU don't drive them together.
+ */
+static void LCD_waitBusyFlag(void)
+{
+	uint8 busy;
+	uint16 polls = 0;
 
 #if(LCD_DATA_BITS_MODE == 4)
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID,GET_BIT(data,4));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID,GET_BIT(data,5));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID,GET_BIT(data,6));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID,GET_BIT(data,7));
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_HIGH); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB4_PIN_ID,GET_BIT(data,0));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB5_PIN_ID,GET_BIT(data,1));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB6_PIN_ID,GET_BIT(data,2));
-	GPIO_writePin(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID,GET_BIT(data,3));
-
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
+	GPIO_DDR_REG(LCD_DATA_PORT_ID) &= (uint8)~LCD_DATA_NIBBLE_MASK;
+#elif(LCD_DATA_BITS_MODE == 8)
+	GPIO_DDR_REG(LCD_DATA_PORT_ID) = PORT_INPUT;
+#endif
+	GPIO_CLEAR_PIN(LCD_RS_PORT_ID,LCD_RS_PIN_ID); /* Busy flag and address RS=0 */
+	GPIO_SET_PIN(LCD_RW_PORT_ID,LCD_RW_PIN_ID); /* Read R/W=1 */
 
+	do
+	{
+		GPIO_SET_PIN(LCD_E_PORT_ID,LCD_E_PIN_ID);
+		LCD_DELAY_US(LCD_ENABLE_PULSE_US); /* delay for the data Tddr = 160ns */
+#if(LCD_DATA_BITS_MODE == 4)
+		busy = GPIO_READ_PIN(LCD_DATA_PORT_ID,LCD_DB7_PIN_ID);
+		GPIO_CLEAR_PIN(LCD_E_PORT_ID,LCD_E_PIN_ID);
+		LCD_DELAY_US(LCD_ENABLE_PULSE_US);
+
+		/* The low nibble holds the address, it is read only to complete the byte */
+		GPIO_SET_PIN(LCD_E_PORT_ID,LCD_E_PIN_ID);
+		LCD_DELAY_US(LCD_ENABLE_PULSE_US);
+#elif(LCD_DATA_BITS_MODE == 8)
+		busy = GPIO_READ_PIN(LCD_DATA_PORT_ID,PIN7_ID);
+#endif
+		GPIO_CLEAR_PIN(LCD_E_PORT_ID,LCD_E_PIN_ID);
+		LCD_DELAY_US(LCD_ENABLE_PULSE_US);
+	} while((busy == LOGIC_HIGH) && (++polls < LCD_BUSY_FLAG_MAX_POLLS));
+
+	GPIO_CLEAR_PIN(LCD_RW_PORT_ID,LCD_RW_PIN_ID); /* Write R/W=0 */
+#if(LCD_DATA_BITS_MODE == 4)
+	GPIO_DDR_REG(LCD_DATA_PORT_ID) |= LCD_DATA_NIBBLE_MASK;
 #elif(LCD_DATA_BITS_MODE == 8)
-	GPIO_writePort(LCD_DATA_PORT_ID,data); /* out the required command to the data bus D0 --> D7 */
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
+	GPIO_DDR_REG(LCD_DATA_PORT_ID) = PORT_OUTPUT;
 #endif
+
+	if(busy == LOGIC_HIGH)
+	{
+		g_busyFlagValid = FALSE;
+		LCD_DELAY_US(LCD_EXECUTION_TIME_US);
+	}
 }
+#endif
 
 /*
  * Description :
@@ -151,32 +309,53 @@ void LCD_displayString(const char *Str)
 	*********************************************************/
 }
 
+/*
+ * Description :
+ * Display the required string stored in the flash on the screen
+ */
+void LCD_displayString_P(PGM_P Str)
+{
+	uint8 character;
+
+	while((character = pgm_read_byte(Str)) != '\0')
+	{
+		LCD_displayCharacter(character);
+		Str++;
+	}
+}
+
 /*
  * Description :
  * Move the cursor to a specified row and column index on the screen
  */
 void LCD_moveCursor(uint8 row,uint8 col)
 {
-	uint8 lcd_memory_address;
-	
-	/* Calculate the required address in the LCD DDRAM */
+	/* Move the LCD cursor to this specific address */
+	LCD_sendCommand(LCD_cellAddress(row,col) | LCD_SET_CURSOR_LOCATION);
+}
+
+/*
+ * Description :
+ * Calculate the address of a specified row and column index in the LCD DDRAM
+ */
+static uint8 LCD_cellAddress(uint8 row,uint8 col)
+{
+	uint8 lcd_memory_address = col; /* Row 0 starts at address 0 */
+
 	switch(row)
 	{
-		case 0:
-			lcd_memory_address=col;
-				break;
 		case 1:
 			lcd_memory_address=col+0x40;
 				break;
 		case 2:
-			lcd_memory_address=col+0x10;
+			lcd_memory_address=col+LCD_COLS;
 				break;
 		case 3:
-			lcd_memory_address=col+0x50;
+			lcd_memory_address=col+0x40+LCD_COLS;
 				break;
-	}					
-	/* Move the LCD cursor to this specific address */
-	LCD_sendCommand(lcd_memory_address | LCD_SET_CURSOR_LOCATION);
+	}
+
+	return lcd_memory_address;
 }
 
 /*
@@ -208,3 +387,301 @@ void LCD_clearScreen(void)
 {
 	LCD_sendCommand(LCD_CLEAR_COMMAND); /* Send clear display command */
 }
+
+/*
+ * Description :
+ * Fill the frame buffer with spaces and move its cursor to the first cell.
+ */
+void LCD_bufferClear(void)
+{
+	uint8 row,col;
+
+	for(row = 0; row < LCD_ROWS; row++)
+	{
+		for(col = 0; col < LCD_COLS; col++)
+		{
+			if(g_frame[row][col] != ' ')
+			{
+				g_frame[row][col] = ' ';
+				g_frameChanged = TRUE;
+			}
+		}
+	}
+	g_bufferRow = 0;
+	g_bufferCol = 0;
+}
+
+/*
+ * Description :
+ * Move the cursor of the frame buffer to a specified row and column index.
+ */
+void LCD_bufferMoveCursor(uint8 row,uint8 col)
+{
+	g_bufferRow = row;
+	g_bufferCol = col;
+}
+
+/*
+ * Description :
+ * Write the required character in the frame buffer at its cursor.
+ */
+void LCD_bufferCharacter(uint8 data)
+{
+	if((g_bufferRow < LCD_ROWS) && (g_bufferCol < LCD_COLS))
+	{
+		/* Writing the same character again doesn't need a flush */
+		if(g_frame[g_bufferRow][g_bufferCol] != data)
+		{
+			g_frame[g_bufferRow][g_bufferCol] = data;
+			g_frameChanged = TRUE;
+		}
+		g_bufferCol++;
+	}
+}
+
+/*
+ * Description :
+ * Write the required string in the frame buffer at its cursor.
+ */
+void LCD_bufferString(const char *Str)
+{
+	uint8 i = 0;
+	while(Str[i] != '\0')
+	{
+		LCD_bufferCharacter(Str[i]);
+		i++;
+	}
+}
+
+/*
+ * Description :
+ * Write the required string stored in the flash in the frame buffer at its cursor.
+ */
+void LCD_bufferString_P(PGM_P Str)
+{
+	uint8 character;
+
+	while((character = pgm_read_byte(Str)) != '\0')
+	{
+		LCD_bufferCharacter(character);
+		Str++;
+	}
+}
+
+/*
+ * Description :
+ * Write the required string in the frame buffer in a specified row and column index.
+ */
+void LCD_bufferStringRowColumn(uint8 row,uint8 col,const char *Str)
+{
+	LCD_bufferMoveCursor(row,col);
+	LCD_bufferString(Str);
+}
+
+/*
+ * Description :
+ * Write the required string stored in the flash in the frame buffer in a specified row and column index.
+ */
+void LCD_bufferStringRowColumn_P(uint8 row,uint8 col,PGM_P Str)
+{
+	LCD_bufferMoveCursor(row,col);
+	LCD_bufferString_P(Str);
+}
+
+/*
+ * Description :
+ * Write the required decimal value in the frame buffer at its cursor.
+ */
+void LCD_bufferIntgerToString(int data)
+{
+   char buff[16]; /* String to hold the ascii result */
+   itoa(data,buff,10); /* Use itoa C function to convert the data to its corresponding ASCII value, 10 for decimal */
+   LCD_bufferString(buff);
+}
+
+/*
+ * Description :
+ * Send the cells of the frame buffer that differ from the screen with the least cursor moves.
+ */
+void LCD_flush(void)
+{
+	uint8 row,col;
+	boolean cursor_valid;
+
+	if(g_frameChanged == FALSE)
+	{
+		return;
+	}
+	g_frameChanged = FALSE;
+
+	for(row = 0; row < LCD_ROWS; row++)
+	{
+		/* The address doesn't move from the end of a row to the next row */
+		cursor_valid = FALSE;
+		for(col = 0; col < LCD_COLS; col++)
+		{
+			if(g_frame[row][col] == g_screen[row][col])
+			{
+				cursor_valid = FALSE;
+				continue;
+			}
+
+			/* The rest of the cells are sent by the next flush */
+			if((uint8)((g_queueTail - g_queueHead - 1) & (LCD_QUEUE_SIZE - 1)) < LCD_CELL_ENTRIES)
+			{
+				g_frameChanged = TRUE;
+				return;
+			}
+
+			if(cursor_valid == FALSE)
+			{
+				LCD_queue(LCD_SET_CURSOR_LOCATION | LCD_cellAddress(row,col), TRUE);
+				cursor_valid = TRUE;
+			}
+			/* The LCD moves its cursor to the next cell after every character */
+			LCD_queue(g_frame[row][col], FALSE);
+			g_screen[row][col] = g_frame[row][col];
+		}
+	}
+}
+
+/*
+ * Description :
+ * Queue the required command to be sent in the background.
+ */
+boolean LCD_queueCommand(uint8 command)
+{
+	return LCD_queue(command, TRUE);
+}
+
+/*
+ * Description :
+ * Queue the required character to be sent in the background.
+ */
+boolean LCD_queueCharacter(uint8 data)
+{
+	return LCD_queue(data, FALSE);
+}
+
+/*
+ * Description :
+ * Copy the statistics of the background queue.
+ */
+void LCD_getQueueStats(LCD_QueueStats *stats)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	*stats = g_queueStats;
+	stats->depth = (uint8)((g_queueHead - g_queueTail) & (LCD_QUEUE_SIZE - 1));
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Add an entry to the background queue, only the main program adds entries.
+ */
+static boolean LCD_queue(uint8 value, boolean command)
+{
+	uint8 next = (uint8)((g_queueHead + 1) & (LCD_QUEUE_SIZE - 1));
+	uint8 depth;
+	uint8 sreg;
+
+	if(next == g_queueTail)
+	{
+		g_queueStats.overflows++;
+		return FALSE;
+	}
+
+	g_queue[g_queueHead] = value;
+	if(command)
+	{
+		g_queueCommands[g_queueHead >> 3] |= (uint8)(1 << (g_queueHead & 7));
+	}
+	else
+	{
+		g_queueCommands[g_queueHead >> 3] &= (uint8)~(1 << (g_queueHead & 7));
+	}
+
+	/* The drain time and the drain timer start when an entry is added to an empty queue */
+	sreg = SREG;
+	cli();
+	if(g_queueHead == g_queueTail)
+	{
+		g_drainStart = SysTick_getTicks();
+		if(SysTick_isTimerActive(&g_drainTimer) == FALSE)
+		{
+			SysTick_startTimer(&g_drainTimer, SYSTICK_TICK_MS, SYSTICK_TICK_MS, LCD_drainQueue);
+		}
+	}
+	g_queueHead = next;
+	depth = (uint8)((g_queueHead - g_queueTail) & (LCD_QUEUE_SIZE - 1));
+	if(depth > g_queueStats.max_depth)
+	{
+		g_queueStats.max_depth = depth;
+	}
+	SREG = sreg;
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Send up to LCD_QUEUE_BYTES_PER_TICK entries of the queue, it runs in the SysTick interrupt.
+ * The last entry of a tick has the time until the next tick to execute.
+ * The timer stops once the queue is empty and the last long instruction has its time.
+ */
+static void LCD_drainQueue(SysTick_Timer *timer)
+{
+	uint8 count;
+	uint8 value;
+	boolean command;
+	uint32 time;
+
+	if(g_skipTicks != 0)
+	{
+		g_skipTicks--;
+		if((g_skipTicks == 0) && (g_queueTail == g_queueHead))
+		{
+			SysTick_stopTimer(timer);
+		}
+		return;
+	}
+
+	for(count = 0; (count < LCD_QUEUE_BYTES_PER_TICK) && (g_queueTail != g_queueHead); count++)
+	{
+		if(count != 0)
+		{
+			LCD_waitExecution(FALSE);
+		}
+
+		value = g_queue[g_queueTail];
+		command = BIT_IS_SET(g_queueCommands[g_queueTail >> 3], (g_queueTail & 7)) ? TRUE : FALSE;
+		LCD_write(command ? LOGIC_LOW : LOGIC_HIGH, value);
+		g_queueTail = (uint8)((g_queueTail + 1) & (LCD_QUEUE_SIZE - 1));
+		g_queueStats.bytes++;
+
+		if(command && ((value == LCD_CLEAR_COMMAND) || (value == LCD_GO_TO_HOME)))
+		{
+			g_skipTicks = LCD_LONG_EXECUTION_TICKS;
+			break;
+		}
+	}
+
+	if((g_queueTail == g_queueHead) && (g_skipTicks == 0))
+	{
+		/* A new entry starts it again one tick later, after the last entry is executed */
+		SysTick_stopTimer(timer);
+	}
+
+	if((count != 0) && (g_queueTail == g_queueHead))
+	{
+		time = SysTick_getTicks() - g_drainStart;
+		g_queueStats.drains++;
+		g_queueStats.total_drain_time += time;
+		if(time > g_queueStats.max_drain_time)
+		{
+			g_queueStats.max_drain_time = time;
+		}
+	}
+}
@@ -3,6 +3,8 @@
 #define LCD_H_
 
 #include "std_types.h"
+#include "gpio.h"
+#include <avr/pgmspace.h>
 
 /*******************************************************************************
  *                                Definitions                                  *
@@ -17,6 +19,25 @@
 
 #endif
 
+/* LCD size, the frame buffer holds one byte for every cell */
+#define LCD_ROWS                       2
+#define LCD_COLS                       16
+
+#if ((LCD_ROWS < 1) || (LCD_ROWS > 4) || (LCD_COLS < 1) || (LCD_COLS > 20))
+#error "The LCD should have 1 to 4 rows and 1 to 20 columns"
+#endif
+
+/*
+ * Entries of the background queue drained by the SysTick timer, and the bytes sent
+ * on every tick. Every byte after the first one in a tick waits the execution time.
+ */
+#define LCD_QUEUE_SIZE                 64
+#define LCD_QUEUE_BYTES_PER_TICK       4
+
+#if ((LCD_QUEUE_SIZE & (LCD_QUEUE_SIZE - 1)) != 0) || (LCD_QUEUE_SIZE > 128)
+#error "The LCD queue size should be a power of 2 up to 128"
+#endif
+
 /* LCD HW Ports and Pins Ids */
 #define LCD_RS_PORT_ID                 PORTB_ID
 #define LCD_RS_PIN_ID                  PIN1_ID
@@ -33,8 +54,41 @@
 #define LCD_DB6_PIN_ID                 PIN5_ID
 #define LCD_DB7_PIN_ID                 PIN6_ID
 
+/* The 4 data pins should be in order so a nibble is written with one masked write */
+#if ((LCD_DB5_PIN_ID != LCD_DB4_PIN_ID + 1) || (LCD_DB6_PIN_ID != LCD_DB4_PIN_ID + 2) || \
+		(LCD_DB7_PIN_ID != LCD_DB4_PIN_ID + 3))
+#error "LCD_DB4 to LCD_DB7 should be consecutive pins"
+#endif
+
+#define LCD_DATA_NIBBLE_MASK           (0x0F << LCD_DB4_PIN_ID)
+
+#endif
+
+/*
+ * Set to 1 if the R/W pin is connected, the busy flag is polled before every instruction.
+ * Set to 0 if R/W is tied low, every instruction waits its worst case execution time.
+ */
+#define LCD_USE_BUSY_FLAG              0
+
+#if (LCD_USE_BUSY_FLAG == 1)
+
+#define LCD_RW_PORT_ID                 PORTB_ID
+#define LCD_RW_PIN_ID                  PIN2_ID
+
 #endif
 
+/* LCD timing in us from the HD44780 datasheet */
+#define LCD_POWER_ON_TIME_US           20000
+#define LCD_EXECUTION_TIME_US          40    /* 37us for most instructions and the data writes */
+#define LCD_LONG_EXECUTION_TIME_US     1530  /* Clear display and return home */
+#define LCD_ENABLE_PULSE_US            1
+
+/*
+ * Busy wait the required time in us, the cycles are calculated at compile time so
+ * the delay is exact even without optimization, unlike _delay_us.
+ */
+#define LCD_DELAY_US(us)               __builtin_avr_delay_cycles((uint32)((F_CPU / 1000000UL) * (us)))
+
 /* LCD Commands */
 #define LCD_CLEAR_COMMAND                    0x01
 #define LCD_GO_TO_HOME                       0x02
@@ -46,6 +100,22 @@
 #define LCD_CURSOR_ON                        0x0E
 #define LCD_SET_CURSOR_LOCATION              0x80
 
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* Statistics of the background queue, the times are in SysTick ticks */
+typedef struct
+{
+	uint8 depth;               /* Entries waiting now */
+	uint8 max_depth;
+	uint32 bytes;              /* Entries sent by the background engine */
+	uint32 overflows;          /* Entries refused because the queue was full */
+	uint32 drains;             /* Times the queue was emptied */
+	uint32 total_drain_time;   /* From the first entry in an empty queue until it is empty again */
+	uint32 max_drain_time;
+}LCD_QueueStats;
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -55,18 +125,22 @@
  * Initialize the LCD:
  * 1. Setup the LCD pins directions by use the GPIO driver.
  * 2. Setup the LCD Data Mode 4-bits or 8-bits.
+ * 3. Prepare the background queue, its SysTick timer runs only while it has entries.
+ *    SysTick should be initialized.
  */
 void LCD_init(void);
 
 /*
  * Description :
- * Send the required command to the screen
+ * Send the required command to the screen and wait for it.
+ * It writes the LCD directly, after LCD_init use LCD_queueCommand.
  */
 void LCD_sendCommand(uint8 command);
 
 /*
  * Description :
- * Display the required character on the screen
+ * Display the required character on the screen and wait for it.
+ * It writes the LCD directly, after LCD_init use the frame buffer.
  */
 void LCD_displayCharacter(uint8 data);
 
@@ -76,6 +150,12 @@ void LCD_displayCharacter(uint8 data);
  */
 void LCD_displayString(const char *Str);
 
+/*
+ * Description :
+ * Display the required string stored in the flash on the screen
+ */
+void LCD_displayString_P(PGM_P Str);
+
 /*
  * Description :
  * Move the cursor to a specified row and column index on the screen
@@ -100,4 +180,84 @@ void LCD_intgerToString(int data);
  */
 void LCD_clearScreen(void);
 
+/*
+ * Description :
+ * Fill the frame buffer with spaces and move its cursor to the first cell.
+ * Nothing is sent to the screen until LCD_flush.
+ */
+void LCD_bufferClear(void);
+
+/*
+ * Description :
+ * Move the cursor of the frame buffer to a specified row and column index.
+ */
+void LCD_bufferMoveCursor(uint8 row,uint8 col);
+
+/*
+ * Description :
+ * Write the required character in the frame buffer at its cursor.
+ * The characters after the end of the row are dropped.
+ */
+void LCD_bufferCharacter(uint8 data);
+
+/*
+ * Description :
+ * Write the required string in the frame buffer at its cursor.
+ */
+void LCD_bufferString(const char *Str);
+
+/*
+ * Description :
+ * Write the required string stored in the flash in the frame buffer at its cursor.
+ */
+void LCD_bufferString_P(PGM_P Str);
+
+/*
+ * Description :
+ * Write the required string in the frame buffer in a specified row and column index.
+ */
+void LCD_bufferStringRowColumn(uint8 row,uint8 col,const char *Str);
+
+/*
+ * Description :
+ * Write the required string stored in the flash in the frame buffer in a specified row and column index.
+ */
+void LCD_bufferStringRowColumn_P(uint8 row,uint8 col,PGM_P Str);
+
+/*
+ * Description :
+ * Write the required decimal value in the frame buffer at its cursor.
+ */
+void LCD_bufferIntgerToString(int data);
+
+/*
+ * Description :
+ * Queue the cells of the frame buffer that differ from the screen, they are sent in the background.
+ * The cursor is moved only when the next changed cell doesn't follow the last written one.
+ * It returns at once if the frame buffer was not changed since the last flush, and the cells
+ * that don't fit in the queue are left for the next flush.
+ * The screen should be changed only through the frame buffer or the queue after LCD_init.
+ */
+void LCD_flush(void);
+
+/*
+ * Description :
+ * Queue the required command to be sent in the background.
+ * Return FALSE if the queue is full.
+ */
+boolean LCD_queueCommand(uint8 command);
+
+/*
+ * Description :
+ * Queue the required character to be sent in the background.
+ * Return FALSE if the queue is full.
+ */
+boolean LCD_queueCharacter(uint8 data);
+
+/*
+ * Description :
+ * Copy the statistics of the background queue.
+ */
+void LCD_getQueueStats(LCD_QueueStats *stats);
+
 #endif /* LCD_H_ */
@@ -0,0 +1,37 @@
+ /******************************************************************************
+ *
+ * Module: MESSAGES
+ *
+ * File Name: messages.c
+ *
+ * Description: Source file for the LCD messages stored in the flash memory
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#include "messages.h"
+
+/*******************************************************************************
+ *                              Messages Catalogue                             *
+ *******************************************************************************/
+
+const char MSG_ENTER_PASS[] PROGMEM = "Plz Enter Pass:";
+const char MSG_REENTER_PASS[] PROGMEM = "Plz reEnter Pass:";
+const char MSG_MATCHING[] PROGMEM = "Matching....";
+const char MSG_NOT_MATCHING[] PROGMEM = "Not Matching!";
+const char MSG_OPTIONS_ROW_0[] PROGMEM = "+:Open -:ChgPass";
+const char MSG_OPTIONS_ROW_1[] PROGMEM = "*:Add %:Remove";
+const char MSG_INVALID_KEY[] PROGMEM = "Enter Valid Key";
+const char MSG_CORRECT_PASS[] PROGMEM = "Correct pass";
+const char MSG_WRONG_PASS[] PROGMEM = "Not Correct!";
+const char MSG_ERROR[] PROGMEM = "Error !!!";
+const char MSG_DOOR_UNLOCKING[] PROGMEM = "Door Un-locking";
+const char MSG_DOOR_HOLDING[] PROGMEM = "Holding";
+const char MSG_DOOR_LOCKING[] PROGMEM = "Door Locking";
+const char MSG_USER_ID[] PROGMEM = "User ID:";
+const char MSG_USER_CODE[] PROGMEM = "User Code:";
+const char MSG_USER_ADDED[] PROGMEM = "User Added";
+const char MSG_USER_NOT_ADDED[] PROGMEM = "Can't Add User";
+const char MSG_USER_REMOVED[] PROGMEM = "User Removed";
+const char MSG_UNKNOWN_USER[] PROGMEM = "Unknown User";
@@ -0,0 +1,46 @@
+ /******************************************************************************
+ *
+ * Module: MESSAGES
+ *
+ * File Name: messages.h
+ *
+ * Description: Header file for the LCD messages stored in the flash memory
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#ifndef MESSAGES_H_
+#define MESSAGES_H_
+
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ *                              Messages Catalogue                             *
+ *******************************************************************************/
+
+/*
+ * The messages are read from the flash with the _P functions of the LCD driver,
+ * they don't take any RAM.
+ */
+extern const char MSG_ENTER_PASS[] PROGMEM;
+extern const char MSG_REENTER_PASS[] PROGMEM;
+extern const char MSG_MATCHING[] PROGMEM;
+extern const char MSG_NOT_MATCHING[] PROGMEM;
+extern const char MSG_OPTIONS_ROW_0[] PROGMEM;
+extern const char MSG_OPTIONS_ROW_1[] PROGMEM;
+extern const char MSG_INVALID_KEY[] PROGMEM;
+extern const char MSG_CORRECT_PASS[] PROGMEM;
+extern const char MSG_WRONG_PASS[] PROGMEM;
+extern const char MSG_ERROR[] PROGMEM;
+extern const char MSG_DOOR_UNLOCKING[] PROGMEM;
+extern const char MSG_DOOR_HOLDING[] PROGMEM;
+extern const char MSG_DOOR_LOCKING[] PROGMEM;
+extern const char MSG_USER_ID[] PROGMEM;
+extern const char MSG_USER_CODE[] PROGMEM;
+extern const char MSG_USER_ADDED[] PROGMEM;
+extern const char MSG_USER_NOT_ADDED[] PROGMEM;
+extern const char MSG_USER_REMOVED[] PROGMEM;
+extern const char MSG_UNKNOWN_USER[] PROGMEM;
+
+#endif /* MESSAGES_H_ */
@@ -0,0 +1,91 @@
+ /******************************************************************************
+ *
+ * Module: POWER
+ *
+ * File Name: power.h
+ *
+ * Description: Header file for the Idle sleep between events and its duty cycle statistics
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#ifndef POWER_H_
+#define POWER_H_
+
+#include "std_types.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Sleep until the condition becomes FALSE, it should be changed by an interrupt.
+ * The condition is checked with the interrupts disabled so its interrupt can't be
+ * missed between the check and the sleep. The interrupts should be enabled.
+ */
+#define POWER_WAIT_WHILE(condition) \
+	do { \
+		uint8 power_sreg = SREG; \
+		cli(); \
+		while(condition) \
+		{ \
+			POWER_idle(); \
+			cli(); \
+		} \
+		SREG = power_sreg; \
+	} while(0)
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* Times in SysTick ticks since POWER_init or the last POWER_resetStats */
+typedef struct
+{
+	uint32 wakeups;       /* Sleeps ended by an interrupt */
+	uint32 sleep_time;
+	uint32 total_time;
+}POWER_Stats;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Select the Idle sleep mode and start the statistics, SysTick should be initialized.
+ * Timer1, the UART, the TWI and the external interrupts keep running in Idle and wake the CPU.
+ */
+void POWER_init(void);
+
+/*
+ * Description :
+ * Sleep in Idle until the next interrupt.
+ * It should be called with the interrupts disabled after checking there is nothing to do,
+ * the interrupts are enabled just before the sleep instruction so an interrupt after the
+ * check wakes the CPU at once. It returns with the interrupts enabled.
+ */
+void POWER_idle(void);
+
+/*
+ * Description :
+ * Copy the sleep statistics.
+ */
+void POWER_getStats(POWER_Stats *stats);
+
+/*
+ * Description :
+ * Return the percentage of time the CPU was awake.
+ */
+uint8 POWER_getDutyCycle(void);
+
+/*
+ * Description :
+ * Clear the statistics to measure a new period.
+ */
+void POWER_resetStats(void);
+
+#endif /* POWER_H_ */
@@ -0,0 +1,155 @@
+ /******************************************************************************
+ *
+ * Module: PROTOCOL
+ *
+ * File Name: protocol.c
+ *
+ * Description: Source file for the framed HMI <-> CONTROL UART protocol
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#include "protocol.h"
+#include "uart.h"
+#include "crc.h"
+#include "power.h"
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+typedef enum
+{
+	PROTOCOL_WAIT_START,
+	PROTOCOL_WAIT_TYPE,
+	PROTOCOL_WAIT_LENGTH,
+	PROTOCOL_WAIT_PAYLOAD,
+	PROTOCOL_WAIT_CRC
+}PROTOCOL_ParserState;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Receive parser state, kept between calls so frames can arrive in pieces */
+static PROTOCOL_ParserState g_parserState = PROTOCOL_WAIT_START;
+static uint8 g_parserIndex = 0;
+static uint8 g_parserCrc = CRC8_INITIAL_VALUE;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Build a frame from the message type and payload and send it in one burst.
+ */
+void PROTOCOL_sendFrame(uint8 type, const uint8 *payload, uint8 length)
+{
+	uint8 buffer[PROTOCOL_MAX_PAYLOAD + PROTOCOL_FRAME_OVERHEAD];
+	uint8 size = 0;
+	uint8 sent;
+	uint8 i;
+
+	if(length > PROTOCOL_MAX_PAYLOAD)
+	{
+		/* Do Nothing */
+		return;
+	}
+
+	buffer[size++] = PROTOCOL_START_BYTE;
+	buffer[size++] = type;
+	buffer[size++] = length;
+	for(i = 0; i < length; i++)
+	{
+		buffer[size++] = payload[i];
+	}
+	/* CRC covers type, length and payload (everything after the start byte) */
+	buffer[size] = CRC8_compute(&buffer[1], (uint8)(size - 1));
+	size++;
+
+	/* Queue as much as possible at once, then wait for room for the rest */
+	sent = UART_writeBuffer(buffer, size);
+	for(i = sent; i < size; i++)
+	{
+		UART_sendByte(buffer[i]);
+	}
+}
+
+/*
+ * Description :
+ * Send a reply frame holding the required status.
+ */
+void PROTOCOL_sendReply(PROTOCOL_Status status)
+{
+	uint8 data = (uint8)status;
+	PROTOCOL_sendFrame(PROTOCOL_MSG_REPLY, &data, 1);
+}
+
+/*
+ * Description :
+ * Feed the received bytes to the frame parser without waiting.
+ * Return TRUE when a complete frame with a valid CRC is stored in frame.
+ * Frames with a bad CRC are dropped and the parser hunts for the next start byte.
+ */
+boolean PROTOCOL_poll(PROTOCOL_Frame *frame)
+{
+	uint8 data;
+
+	while(UART_tryReceive(&data))
+	{
+		switch(g_parserState)
+		{
+		case PROTOCOL_WAIT_START:
+			if(data == PROTOCOL_START_BYTE)
+			{
+				g_parserCrc = CRC8_INITIAL_VALUE;
+				g_parserState = PROTOCOL_WAIT_TYPE;
+			}
+			break;
+		case PROTOCOL_WAIT_TYPE:
+			frame->type = data;
+			g_parserCrc = CRC8_update(g_parserCrc, data);
+			g_parserState = PROTOCOL_WAIT_LENGTH;
+			break;
+		case PROTOCOL_WAIT_LENGTH:
+			if(data > PROTOCOL_MAX_PAYLOAD)
+			{
+				/* Corrupted length, resynchronize on the next start byte */
+				g_parserState = PROTOCOL_WAIT_START;
+				break;
+			}
+			frame->length = data;
+			g_parserCrc = CRC8_update(g_parserCrc, data);
+			g_parserIndex = 0;
+			g_parserState = (data == 0) ? PROTOCOL_WAIT_CRC : PROTOCOL_WAIT_PAYLOAD;
+			break;
+		case PROTOCOL_WAIT_PAYLOAD:
+			frame->payload[g_parserIndex++] = data;
+			g_parserCrc = CRC8_update(g_parserCrc, data);
+			if(g_parserIndex == frame->length)
+			{
+				g_parserState = PROTOCOL_WAIT_CRC;
+			}
+			break;
+		case PROTOCOL_WAIT_CRC:
+			g_parserState = PROTOCOL_WAIT_START;
+			if(data == g_parserCrc)
+			{
+				return TRUE;
+			}
+			break;
+		}
+	}
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Wait until a complete valid frame is received.
+ */
+void PROTOCOL_receiveFrame(PROTOCOL_Frame *frame)
+{
+	/* Every received byte wakes the CPU to parse it */
+	POWER_WAIT_WHILE(PROTOCOL_poll(frame) == FALSE);
+}
@@ -0,0 +1,106 @@
+ /******************************************************************************
+ *
+ * Module: PROTOCOL
+ *
+ * File Name: protocol.h
+ *
+ * Description: Header file for the framed HMI <-> CONTROL UART protocol
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#ifndef PROTOCOL_H_
+#define PROTOCOL_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Frame format:
+ * | START | TYPE | LENGTH | PAYLOAD (LENGTH bytes) | CRC-8 |
+ * The CRC-8 is calculated over TYPE, LENGTH and PAYLOAD.
+ */
+#define PROTOCOL_START_BYTE            0x7E
+#define PROTOCOL_MAX_PAYLOAD           16
+#define PROTOCOL_FRAME_OVERHEAD        4
+
+/* Password length shared by both ECUs, also used for the user codes */
+#define PROTOCOL_PASS_LENGTH           5
+
+/* Offsets of the user ID and code in the enroll and revoke payloads */
+#define PROTOCOL_USER_ID_INDEX         PROTOCOL_PASS_LENGTH
+#define PROTOCOL_USER_CODE_INDEX       (PROTOCOL_PASS_LENGTH + 1)
+
+/* Offsets in the streamed digit payload */
+#define PROTOCOL_DIGIT_INDEX           0
+#define PROTOCOL_DIGIT_VALUE           1
+#define PROTOCOL_DIGIT_LENGTH          2
+
+/* Message types (HMI -> CONTROL) */
+#define PROTOCOL_MSG_NEW_PASS          0x01 /* Payload: password + confirmation password */
+#define PROTOCOL_MSG_OPEN_DOOR         0x02 /* Payload: password, or empty to use the streamed digits */
+#define PROTOCOL_MSG_CHANGE_PASS       0x03 /* Payload: password, or empty to use the streamed digits */
+#define PROTOCOL_MSG_ENROLL            0x04 /* Payload: master password + user ID + user code */
+#define PROTOCOL_MSG_REVOKE            0x05 /* Payload: master password + user ID */
+#define PROTOCOL_MSG_PASS_DIGIT        0x06 /* Payload: digit index + digit, sent as it is typed, no reply */
+#define PROTOCOL_MSG_GET_STATE         0x07 /* Payload: none, MATCH if a password is set, MISMATCH if a new one is needed */
+
+/* Message types (CONTROL -> HMI) */
+#define PROTOCOL_MSG_REPLY             0x81 /* Payload: PROTOCOL_Status of the last request */
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+typedef enum
+{
+	PROTOCOL_STATUS_MATCH,    /* Password accepted */
+	PROTOCOL_STATUS_MISMATCH, /* Password refused, the user can try again */
+	PROTOCOL_STATUS_LOCKOUT,  /* Too many wrong trials, the alarm is on */
+	PROTOCOL_STATUS_REFUSED,  /* Password accepted but the user operation can not be done */
+	PROTOCOL_STATUS_INVALID   /* The request payload has a wrong length, nothing is done */
+}PROTOCOL_Status;
+
+typedef struct
+{
+	uint8 type;
+	uint8 length;
+	uint8 payload[PROTOCOL_MAX_PAYLOAD];
+}PROTOCOL_Frame;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Build a frame from the message type and payload and send it in one burst.
+ */
+void PROTOCOL_sendFrame(uint8 type, const uint8 *payload, uint8 length);
+
+/*
+ * Description :
+ * Send a reply frame holding the required status.
+ */
+void PROTOCOL_sendReply(PROTOCOL_Status status);
+
+/*
+ * Description :
+ * Feed the received bytes to the frame parser without waiting.
+ * Return TRUE when a complete frame with a valid CRC is stored in frame.
+ * Frames with a bad CRC are dropped and the parser hunts for the next start byte.
+ * The same frame should be passed on every call until TRUE is returned,
+ * as a frame may arrive over several calls.
+ */
+boolean PROTOCOL_poll(PROTOCOL_Frame *frame);
+
+/*
+ * Description :
+ * Wait until a complete valid frame is received.
+ */
+void PROTOCOL_receiveFrame(PROTOCOL_Frame *frame);
+
+#endif /* PROTOCOL_H_ */
@@ -0,0 +1,98 @@
+ /******************************************************************************
+ *
+ * Module: PT
+ *
+ * File Name: pt.h
+ *
+ * Description: Stackless threads (protothreads) for writing the waiting flows linearly
+ *
+ * Author: Shorouk Shawky
+ *
+ *******************************************************************************/
+
+#ifndef PT_H_
+#define PT_H_
+
+#include "std_types.h"
+
+/*
+ * A thread is a function returning the PT_xxx status, its body is written between
+ * PT_BEGIN and PT_END. When it waits it returns to the caller and the next call resumes
+ * at the same line, so:
+ * - The local variables are lost on every wait, use static or global variables.
+ * - No switch statement can be used around a wait, use if/else instead.
+ * - Only one wait can be written on a line, the line number is its resume point.
+ */
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Thread status */
+#define PT_WAITING      0
+#define PT_YIELDED      1
+#define PT_EXITED       2
+#define PT_ENDED        3
+
+/*******************************************************************************
+ *                         Types Declaration                                   *
+ *******************************************************************************/
+
+/* Line to resume the thread at, 0 is the beginning */
+typedef struct
+{
+	uint16 lc;
+}PT_Thread;
+
+/*******************************************************************************
+ *                                 Macros                                      *
+ *******************************************************************************/
+
+/* Declare a thread function */
+#define PT_THREAD(name_args)    uint8 name_args
+
+/* Start the thread from its beginning on the next call */
+#define PT_INIT(pt)             ((pt)->lc = 0)
+
+#define PT_BEGIN(pt)            { uint8 pt_yield_flag = 1; if(pt_yield_flag) {;} switch((pt)->lc) { case 0:
+
+#define PT_END(pt)              } pt_yield_flag = 0; PT_INIT(pt); return PT_ENDED; }
+
+/* Wait until the condition is true, it is checked on every call */
+#define PT_WAIT_UNTIL(pt, condition) \
+	do { \
+		(pt)->lc = __LINE__; case __LINE__: \
+		if(!(condition)) { return PT_WAITING; } \
+	} while(0)
+
+#define PT_WAIT_WHILE(pt, condition)    PT_WAIT_UNTIL((pt), !(condition))
+
+/* Return TRUE while the thread is running */
+#define PT_SCHEDULE(f)          ((f) < PT_EXITED)
+
+/* Wait until the child thread ends */
+#define PT_WAIT_THREAD(pt, thread)      PT_WAIT_WHILE((pt), PT_SCHEDULE(thread))
+
+/* Start the child thread and wait until it ends */
+#define PT_SPAWN(pt, child, thread) \
+	do { \
+		PT_INIT((child)); \
+		PT_WAIT_THREAD((pt), (thread)); \
+	} while(0)
+
+/* Return to the caller once and continue on the next call */
+#define PT_YIELD(pt) \
+	do { \
+		pt_yield_flag = 0; \
+		(pt)->lc = __LINE__; case __LINE__: \
+		if(pt_yield_flag == 0) { return PT_YIELDED; } \
+	} while(0)
+
+/* Stop the thread, it starts from its beginning on the next call */
+#define PT_EXIT(pt) \
+	do { \
+		PT_INIT(pt); \
+		return PT_EXITED; \
+	} while(0)
+
+#endif /* PT_H_ */
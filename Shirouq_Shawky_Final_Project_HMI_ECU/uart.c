@@ -3,7 +3,92 @@
 #include "uart.h"
 #include "avr/io.h" /* To use the UART Registers */
 #include "common_macros.h"/* To use the macros like SET_BIT */
+#include <avr/interrupt.h> /* For the UART ISRs */
+#include "power.h" /* To sleep while waiting for the buffers */
 #include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Load the UBRR value and U2X mode calculated at compile time for a constant baud rate */
+#define UART_SET_BAUD(baud) \
+	do { \
+		UBRRH = (uint8)(UART_UBRR(baud) >> 8); \
+		UBRRL = (uint8)(UART_UBRR(baud)); \
+		if(UART_USE_2X(baud)) \
+		{ \
+			SET_BIT(UCSRA, U2X); \
+		} \
+		else \
+		{ \
+			CLEAR_BIT(UCSRA, U2X); \
+		} \
+	} while(0)
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/*
+ * Receive ring buffer (single producer: RX Complete ISR, single consumer: application).
+ * The head index is only written by the ISR and the tail index only by the application,
+ * so no critical section is needed as long as each index is a single byte.
+ */
+static volatile uint8 g_rxBuffer[UART_RX_BUFFER_SIZE];
+static volatile uint8 g_rxHead = 0;
+static volatile uint8 g_rxTail = 0;
+
+/*
+ * Transmit ring buffer (single producer: application, single consumer: UDR Empty ISR).
+ */
+static volatile uint8 g_txBuffer[UART_TX_BUFFER_SIZE];
+static volatile uint8 g_txHead = 0;
+static volatile uint8 g_txTail = 0;
+
+/* Called by the RX Complete ISR after a byte is stored */
+static void (*volatile g_rxCallBackPtr)(void) = NULL_PTR;
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+
+/* RX Complete: move the received byte into the Rx ring buffer */
+ISR(USART_RXC_vect)
+{
+	/* Read UDR first, this also clears the RXC flag */
+	uint8 data = UDR;
+	uint8 next = (uint8)((g_rxHead + 1) & (UART_RX_BUFFER_SIZE - 1));
+
+	/* If the buffer is full the new byte is dropped */
+	if(next != g_rxTail)
+	{
+		g_rxBuffer[g_rxHead] = data;
+		g_rxHead = next;
+	}
+
+	if(g_rxCallBackPtr != NULL_PTR)
+	{
+		(*g_rxCallBackPtr)();
+	}
+}
+
+/* Data Register Empty: feed the next byte from the Tx ring buffer */
+ISR(USART_UDRE_vect)
+{
+	if(g_txTail != g_txHead)
+	{
+		UDR = g_txBuffer[g_txTail];
+		g_txTail = (uint8)((g_txTail + 1) & (UART_TX_BUFFER_SIZE - 1));
+	}
+
+	/* Nothing more to send, disable the interrupt until the next byte is queued */
+	if(g_txTail == g_txHead)
+	{
+		CLEAR_BIT(UCSRB, UDRIE);
+	}
+}
+
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
@@ -52,13 +137,87 @@ void UART_init(const UART_ConfigType * Config_Ptr)
 //	/* First 8 bits from the BAUD_PRESCALE inside UBRRL and last 4 bits in UBRRH*/
 //	UBRRH = ubrr_value>>8;
 //	UBRRL = ubrr_value;
-	uint16 ubrr_value = 0;
-		SET_BIT(UCSRA, U2X);
+		g_rxHead = g_rxTail = 0;
+		g_txHead = g_txTail = 0;
 		SET_BIT(UCSRB, RXEN);
 		SET_BIT(UCSRB, TXEN);
-		ubrr_value = (uint16) ((F_CPU / (Config_Ptr->baud_rate * 8UL)) - 1);
-		UBRRH = ubrr_value >> 8;
-		UBRRL = ubrr_value;
+		SET_BIT(UCSRB, RXCIE); /* Enable RX Complete Interrupt */
+
+		/*
+		 * Every case loads constants calculated at compile time,
+		 * rates that F_CPU can not generate accurately are left out of the table
+		 */
+		switch (Config_Ptr->baud_rate) {
+#if UART_BAUD_SUPPORTED(2400UL)
+		case BAUD_RATE_2400:
+			UART_SET_BAUD(2400UL);
+			break;
+#endif
+#if UART_BAUD_SUPPORTED(4800UL)
+		case BAUD_RATE_4800:
+			UART_SET_BAUD(4800UL);
+			break;
+#endif
+#if UART_BAUD_SUPPORTED(9600UL)
+		case BAUD_RATE_9600:
+			UART_SET_BAUD(9600UL);
+			break;
+#endif
+#if UART_BAUD_SUPPORTED(14400UL)
+		case BAUD_RATE_14400:
+			UART_SET_BAUD(14400UL);
+			break;
+#endif
+#if UART_BAUD_SUPPORTED(19200UL)
+		case BAUD_RATE_19200:
+			UART_SET_BAUD(19200UL);
+			break;
+#endif
+#if UART_BAUD_SUPPORTED(28800UL)
+		case BAUD_RATE_28800:
+			UART_SET_BAUD(28800UL);
+			break;
+#endif
+#if UART_BAUD_SUPPORTED(38400UL)
+		case BAUD_RATE_38400:
+			UART_SET_BAUD(38400UL);
+			break;
+#endif
+#if UART_BAUD_SUPPORTED(57600UL)
+		case BAUD_RATE_57600:
+			UART_SET_BAUD(57600UL);
+			break;
+#endif
+#if UART_BAUD_SUPPORTED(76800UL)
+		case BAUD_RATE_76800:
+			UART_SET_BAUD(76800UL);
+			break;
+#endif
+#if UART_BAUD_SUPPORTED(115200UL)
+		case BAUD_RATE_115200:
+			UART_SET_BAUD(115200UL);
+			break;
+#endif
+#if UART_BAUD_SUPPORTED(128000UL)
+		case BAUD_RATE_128000:
+			UART_SET_BAUD(128000UL);
+			break;
+#endif
+#if UART_BAUD_SUPPORTED(250000UL)
+		case BAUD_RATE_250000:
+			UART_SET_BAUD(250000UL);
+			break;
+#endif
+#if UART_BAUD_SUPPORTED(256000UL)
+		case BAUD_RATE_256000:
+			UART_SET_BAUD(256000UL);
+			break;
+#endif
+		default:
+			UART_SET_BAUD(UART_LINK_BAUD_RATE);
+			break;
+		}
+
 		SET_BIT(UCSRC, URSEL);
 		switch (Config_Ptr->bit_data) {
 		case 0:
@@ -103,23 +262,16 @@ void UART_init(const UART_ConfigType * Config_Ptr)
  */
 void UART_sendByte(const uint8 data)
 {
-	/*
-	 * UDRE flag is set when the Tx buffer (UDR) is empty and ready for
-	 * transmitting a new byte so wait until this flag is set to one
-	 */
-	while(BIT_IS_CLEAR(UCSRA,UDRE)){}
-
-	/*
-	 * Put the required data in the UDR register and it also clear the UDRE flag as
-	 * the UDR register is not empty now
-	 */
-	UDR = data;
+	uint8 next = (uint8)((g_txHead + 1) & (UART_TX_BUFFER_SIZE - 1));
 
-	/************************* Another Method *************************
-	UDR = data;
-	while(BIT_IS_CLEAR(UCSRA,TXC)){} // Wait until the transmission is complete TXC = 1
-	SET_BIT(UCSRA,TXC); // Clear the TXC flag
-	*******************************************************************/
+	/* Sleep until the UDRE interrupt frees a place in the Tx ring buffer */
+	POWER_WAIT_WHILE(next == g_txTail);
+
+	g_txBuffer[g_txHead] = data;
+	g_txHead = next;
+
+	/* Enable UDRE interrupt, it fires as soon as the UDR register is empty */
+	SET_BIT(UCSRB, UDRIE);
 }
 
 /*
@@ -128,14 +280,69 @@ void UART_sendByte(const uint8 data)
  */
 uint8 UART_recieveByte(void)
 {
-	/* RXC flag is set when the UART receive data so wait until this flag is set to one */
-	while(BIT_IS_CLEAR(UCSRA,RXC)){}
-
-	/*
-	 * Read the received data from the Rx buffer (UDR)
-	 * The RXC flag will be cleared after read the data
-	 */
-    return UDR;
+	uint8 data;
+
+	/* Sleep until the RX Complete interrupt puts a byte in the Rx ring buffer */
+	POWER_WAIT_WHILE(UART_tryReceive(&data) == FALSE);
+
+	return data;
+}
+
+/*
+ * Description :
+ * Read one byte from the Rx ring buffer without waiting.
+ * Return TRUE and the byte in data if there was one, or FALSE if the buffer is empty.
+ */
+boolean UART_tryReceive(uint8 *data)
+{
+	if(g_rxHead == g_rxTail)
+	{
+		return FALSE;
+	}
+
+	*data = g_rxBuffer[g_rxTail];
+	g_rxTail = (uint8)((g_rxTail + 1) & (UART_RX_BUFFER_SIZE - 1));
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Return the number of received bytes waiting in the Rx ring buffer.
+ */
+uint8 UART_available(void)
+{
+	return (uint8)((g_rxHead - g_rxTail) & (UART_RX_BUFFER_SIZE - 1));
+}
+
+/*
+ * Description :
+ * Queue up to length bytes in the Tx ring buffer without waiting.
+ * Return the number of bytes actually queued, the rest did not fit in the buffer.
+ */
+uint8 UART_writeBuffer(const uint8 *data, uint8 length)
+{
+	uint8 i;
+	uint8 next;
+
+	for(i = 0; i < length; i++)
+	{
+		next = (uint8)((g_txHead + 1) & (UART_TX_BUFFER_SIZE - 1));
+		if(next == g_txTail)
+		{
+			/* Tx ring buffer is full */
+			break;
+		}
+		g_txBuffer[g_txHead] = data[i];
+		g_txHead = next;
+	}
+
+	if(i != 0)
+	{
+		SET_BIT(UCSRB, UDRIE);
+	}
+
+	return i;
 }
 
 /*
@@ -182,3 +389,12 @@ void UART_receiveString(uint8 *Str)
 	/* After receiving the whole string plus the '#', replace the '#' with '\0' */
 	Str[i] = '\0';
 }
+
+/*
+ * Description :
+ * Set the function called from the RX Complete ISR after every received byte.
+ */
+void UART_setRxCallBack(void(*a_ptr)(void))
+{
+	g_rxCallBackPtr = a_ptr;
+}
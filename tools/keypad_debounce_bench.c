@@ -0,0 +1,211 @@
+/******************************************************************************
+ *
+ * Module: Tools
+ *
+ * File Name: keypad_debounce_bench.c
+ *
+ * Description: Host benchmark of the keypad debounce, it compares the vertical
+ *              counters of the HMI keypad driver with a counter per key.
+ *              Both are fed the same bouncing samples, they should give the
+ *              same debounced state on every scan.
+ *
+ *              gcc -O2 -o keypad_debounce_bench tools/keypad_debounce_bench.c
+ *              ./keypad_debounce_bench [scans]
+ *
+ *******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define NUM_KEYS           16
+#define DEBOUNCE_BITS      2
+#define DEBOUNCE_SCANS     (1 << DEBOUNCE_BITS)
+#define DEFAULT_SCANS      10000000UL
+
+/* Percent of the scans a key changes, and a changing key bounces for up to this number of scans */
+#define CHANGE_PERCENT     2
+#define BOUNCE_SCANS       6
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Counter per key */
+static uint16_t g_naiveState;
+static uint8_t g_naiveCount[NUM_KEYS];
+
+/* Vertical counters, as in keypad.c */
+static uint16_t g_verticalState;
+static uint16_t g_count[DEBOUNCE_BITS];
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Debounce one key at a time, return the keys that changed.
+ */
+static uint16_t naiveDebounce(uint16_t keys)
+{
+	uint16_t changed = 0;
+	uint8_t key_index;
+
+	for(key_index = 0; key_index < NUM_KEYS; key_index++)
+	{
+		uint16_t mask = (uint16_t)(1u << key_index);
+
+		if((keys ^ g_naiveState) & mask)
+		{
+			if(++g_naiveCount[key_index] >= DEBOUNCE_SCANS)
+			{
+				g_naiveCount[key_index] = 0;
+				g_naiveState ^= mask;
+				changed |= mask;
+			}
+		}
+		else
+		{
+			g_naiveCount[key_index] = 0;
+		}
+	}
+
+	return changed;
+}
+
+/*
+ * Description :
+ * Debounce all the keys together, return the keys that changed.
+ */
+static uint16_t verticalDebounce(uint16_t keys)
+{
+	uint16_t delta = keys ^ g_verticalState;
+	uint16_t carry = delta;
+	uint8_t bit;
+
+	for(bit = 0; bit < DEBOUNCE_BITS; bit++)
+	{
+		uint16_t next_carry = g_count[bit] & carry;
+		g_count[bit] = (g_count[bit] ^ carry) & delta;
+		carry = next_carry;
+	}
+
+	g_verticalState ^= carry;
+	return carry;
+}
+
+/*
+ * Description :
+ * Fill the samples with keys that change from time to time and bounce after every change.
+ */
+static void makeSamples(uint16_t *samples, unsigned long scans)
+{
+	uint16_t stable = 0;
+	uint8_t bounce[NUM_KEYS] = {0};
+	unsigned long scan;
+	uint8_t key_index;
+
+	srand(1);
+	for(scan = 0; scan < scans; scan++)
+	{
+		uint16_t sample = 0;
+
+		for(key_index = 0; key_index < NUM_KEYS; key_index++)
+		{
+			uint16_t mask = (uint16_t)(1u << key_index);
+
+			if(bounce[key_index] == 0 && (rand() % (100 * NUM_KEYS)) < CHANGE_PERCENT * NUM_KEYS)
+			{
+				stable ^= mask;
+				bounce[key_index] = (uint8_t)(rand() % (BOUNCE_SCANS + 1));
+			}
+
+			if(bounce[key_index] != 0)
+			{
+				bounce[key_index]--;
+				sample |= (rand() & 1) ? mask : 0;
+			}
+			else
+			{
+				sample |= stable & mask;
+			}
+		}
+		samples[scan] = sample;
+	}
+}
+
+static double elapsedNs(const struct timespec *start, const struct timespec *end)
+{
+	return (double)(end->tv_sec - start->tv_sec) * 1e9 + (double)(end->tv_nsec - start->tv_nsec);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned long scans = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_SCANS;
+	uint16_t *samples = malloc(scans * sizeof(uint16_t));
+	volatile uint16_t sink = 0;
+	unsigned long scan, mismatches = 0, changes = 0;
+	struct timespec start, end;
+	double naive_ns, vertical_ns;
+
+	if(samples == NULL || scans == 0)
+	{
+		fprintf(stderr, "no samples\n");
+		return 1;
+	}
+	makeSamples(samples, scans);
+
+	/* Both debouncers should agree on every scan */
+	for(scan = 0; scan < scans; scan++)
+	{
+		uint16_t naive_changed = naiveDebounce(samples[scan]);
+		uint16_t vertical_changed = verticalDebounce(samples[scan]);
+
+		if(naive_changed != vertical_changed || g_naiveState != g_verticalState)
+		{
+			mismatches++;
+		}
+		changes += (naive_changed != 0);
+	}
+
+	g_naiveState = 0;
+	for(scan = 0; scan < NUM_KEYS; scan++)
+	{
+		g_naiveCount[scan] = 0;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(scan = 0; scan < scans; scan++)
+	{
+		sink ^= naiveDebounce(samples[scan]);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	naive_ns = elapsedNs(&start, &end);
+
+	g_verticalState = 0;
+	for(scan = 0; scan < DEBOUNCE_BITS; scan++)
+	{
+		g_count[scan] = 0;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(scan = 0; scan < scans; scan++)
+	{
+		sink ^= verticalDebounce(samples[scan]);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	vertical_ns = elapsedNs(&start, &end);
+
+	printf("scans            : %lu (%d keys, %d scans debounce)\n", scans, NUM_KEYS, DEBOUNCE_SCANS);
+	printf("scans with change: %lu\n", changes);
+	printf("mismatches       : %lu\n", mismatches);
+	printf("counter per key  : %.2f ns/scan\n", naive_ns / (double)scans);
+	printf("vertical counters: %.2f ns/scan\n", vertical_ns / (double)scans);
+	printf("speedup          : %.1fx\n", naive_ns / vertical_ns);
+
+	free(samples);
+	return (mismatches != 0);
+}